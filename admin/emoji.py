@@ -28,8 +28,15 @@ template_main="""// This is a generated file. See emoji.py for details
 static std::vector<EmojiRegistry::Group> db = {{{groups}
 }};
 
-static std::map<quint32, quint32> ranges = {{
-    {ranges}
+// two-level bitmap of code points an emoji can start with. the code point's
+// high bits select a block (0 - none of the block's code points does), the low
+// 8 bits select a bit in that block
+static const quint8 emojiStartBlocks[] = {{
+    {blocks}
+}};
+
+static const quint32 emojiStartBits[][8] = {{
+    {bits}
 }};
 
 // clang-format on
@@ -107,7 +114,22 @@ def generate_ranges():
     ranges.append((range_start, cur_code))
 
 
+def generate_start_bitmap():
+    codes = set()
+    for r in ranges:
+        codes.update(range(r[0], r[1] + 1))
+    blocks = {}
+    for c in codes:
+        blocks.setdefault(c >> 8, [0] * 8)[(c & 0xff) >> 5] |= 1 << (c & 0x1f)
+    numbers = {b: n + 1 for n, b in enumerate(sorted(blocks))}
+    index = [numbers.get(b, 0) for b in range(max(blocks) + 1)]
+    index_lines = [", ".join(str(i) for i in index[n:n + 32]) for n in range(0, len(index), 32)]
+    bits_lines = ["{" + ", ".join(f"0x{w:08x}" for w in blocks[b]) + "}" for b in sorted(blocks)]
+    return ",\n    ".join(index_lines), ",\n    ".join(bits_lines)
+
+
 def generate_cpp_db():
+    blocks, bits = generate_start_bitmap()
     print(template_main.format(groups=",".join([
         template_group.format(name=group["name"], subgroups=",".join([
             template_subgroup.format(name=sub["name"], emojis=",".join([
@@ -117,7 +139,7 @@ def generate_cpp_db():
             for sub in group["subgroups"]
         ]))
         for group in data
-    ]), ranges=",\n    ".join([f"{{{r[0]}, {r[1]}}}" for r in ranges])))
+    ]), blocks=blocks, bits=bits))
 
 
 # https://unicode.org/Public/emoji/13.0/emoji-test.txt
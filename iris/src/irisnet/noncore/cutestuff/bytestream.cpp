@@ -21,8 +21,128 @@
 
 #include <QByteArray>
 
+#include <cstring>
+
+// blocks this small are merged into the tail chunk rather than queued on
+//   their own, so a stream of tiny writes doesn't become a stream of chunks
+#define CHAIN_MERGE_MAX 512
+
 // CS_NAMESPACE_BEGIN
 
+//! \class ByteChain bytestream.h
+//! \brief Byte queue made of shared chunks
+//!
+//! Appending a QByteArray only takes a shallow copy of it, and consuming from
+//! the front advances an offset instead of moving the remainder, so bytes
+//! that pass through a chain whole are never copied.  Don't append arrays
+//! made with QByteArray::fromRawData() unless the data outlives the chain.
+
+//!
+//! Appends \a block to the end of the chain.
+void ByteChain::append(const QByteArray &block)
+{
+    if (block.isEmpty())
+        return;
+    if (block.size() <= CHAIN_MERGE_MAX && !chunks.isEmpty() && chunks.last().size() <= CHAIN_MERGE_MAX)
+        chunks.last().append(block);
+    else
+        chunks.append(block);
+    total += block.size();
+}
+
+//!
+//! Appends \a size bytes at \a data to the end of the chain.
+void ByteChain::append(const char *data, int size)
+{
+    if (size <= 0)
+        return;
+    if (size <= CHAIN_MERGE_MAX && !chunks.isEmpty() && chunks.last().size() <= CHAIN_MERGE_MAX)
+        chunks.last().append(data, size);
+    else
+        chunks.append(QByteArray(data, size));
+    total += size;
+}
+
+//!
+//! Removes all data.
+void ByteChain::clear()
+{
+    chunks.clear();
+    headOffset = 0;
+    total      = 0;
+}
+
+//!
+//! Returns the first \a size bytes without removing them.
+//! If \a size is 0 or more than available, everything is returned.
+//! No copy is made if the bytes are exactly one whole chunk.
+QByteArray ByteChain::peek(int size) const
+{
+    if (size <= 0 || size > total)
+        size = total;
+    if (size == 0)
+        return QByteArray();
+
+    const QByteArray &head = chunks.first();
+    if (headOffset == 0 && size == head.size())
+        return head;
+
+    QByteArray result;
+    result.reserve(size);
+    int offset = headOffset;
+    for (const QByteArray &c : chunks) {
+        int n = qMin(c.size() - offset, size - result.size());
+        result.append(c.constData() + offset, n);
+        offset = 0;
+        if (result.size() == size)
+            break;
+    }
+    return result;
+}
+
+//!
+//! Removes and returns the first \a size bytes, everything if \a size is 0.
+QByteArray ByteChain::take(int size)
+{
+    QByteArray result = peek(size);
+    skip(result.size());
+    return result;
+}
+
+//!
+//! Copies up to \a maxSize bytes to \a data and removes them.  Returns the
+//! number of bytes copied.
+int ByteChain::read(char *data, int maxSize)
+{
+    int done = 0;
+    while (done < maxSize && !chunks.isEmpty()) {
+        const QByteArray &head = chunks.first();
+        int               n    = qMin(head.size() - headOffset, maxSize - done);
+        memcpy(data + done, head.constData() + headOffset, size_t(n));
+        done += n;
+        skip(n);
+    }
+    return done;
+}
+
+//!
+//! Removes the first \a size bytes.
+void ByteChain::skip(int size)
+{
+    size = qMin(size, total);
+    total -= size;
+    while (size > 0) {
+        int left = chunks.first().size() - headOffset;
+        if (size < left) {
+            headOffset += size;
+            return;
+        }
+        size -= left;
+        chunks.removeFirst();
+        headOffset = 0;
+    }
+}
+
 //! \class ByteStream bytestream.h
 //! \brief Base class for "bytestreams"
 //!
@@ -59,7 +179,7 @@ class ByteStream::Private {
 public:
     Private() { }
 
-    QByteArray readBuf, writeBuf;
+    ByteChain readBuf, writeBuf;
     int        errorCode;
     QString    errorText;
 };
@@ -91,10 +211,7 @@ qint64 ByteStream::writeData(const char *data, qint64 maxSize)
 //! \a read will return all available data.
 qint64 ByteStream::readData(char *data, qint64 maxSize)
 {
-    maxSize = maxSize > d->readBuf.size() ? d->readBuf.size() : maxSize;
-    memcpy(data, d->readBuf.constData(), size_t(maxSize));
-    d->readBuf.remove(0, int(maxSize));
-    return maxSize;
+    return d->readBuf.read(data, int(qMin(maxSize, qint64(d->readBuf.size()))));
 }
 
 //!
@@ -107,39 +224,45 @@ qint64 ByteStream::bytesToWrite() const { return d->writeBuf.size(); }
 
 //!
 //! Clears the read buffer.
-void ByteStream::clearReadBuffer() { d->readBuf.resize(0); }
+void ByteStream::clearReadBuffer() { d->readBuf.clear(); }
 
 //!
 //! Clears the write buffer.
-void ByteStream::clearWriteBuffer() { d->writeBuf.resize(0); }
+void ByteStream::clearWriteBuffer() { d->writeBuf.clear(); }
 
 //!
 //! Appends \a block to the end of the read buffer.
-void ByteStream::appendRead(const QByteArray &block) { d->readBuf += block; }
+void ByteStream::appendRead(const QByteArray &block) { d->readBuf.append(block); }
 
 //!
 //! Appends \a block to the end of the write buffer.
-void ByteStream::appendWrite(const QByteArray &block) { d->writeBuf += block; }
+void ByteStream::appendWrite(const QByteArray &block) { d->writeBuf.append(block); }
 
 //!
 //! Returns \a size bytes from the start of the read buffer.
 //! If \a size is 0, then all available data will be returned.
 //! If \a del is TRUE, then the bytes are also removed.
-QByteArray ByteStream::takeRead(int size, bool del) { return takeArray(d->readBuf, size, del); }
+QByteArray ByteStream::takeRead(int size, bool del)
+{
+    return del ? d->readBuf.take(size) : d->readBuf.peek(size);
+}
 
 //!
 //! Returns \a size bytes from the start of the write buffer.
 //! If \a size is 0, then all available data will be returned.
 //! If \a del is TRUE, then the bytes are also removed.
-QByteArray ByteStream::takeWrite(int size, bool del) { return takeArray(d->writeBuf, size, del); }
+QByteArray ByteStream::takeWrite(int size, bool del)
+{
+    return del ? d->writeBuf.take(size) : d->writeBuf.peek(size);
+}
 
 //!
 //! Returns a reference to the read buffer.
-QByteArray &ByteStream::readBuf() { return d->readBuf; }
+ByteChain &ByteStream::readBuf() { return d->readBuf; }
 
 //!
 //! Returns a reference to the write buffer.
-QByteArray &ByteStream::writeBuf() { return d->writeBuf; }
+ByteChain &ByteStream::writeBuf() { return d->writeBuf; }
 
 //!
 //! Attempts to try and write some bytes from the write buffer, and returns the number
@@ -22,12 +22,31 @@
 
 #include <QByteArray>
 #include <QIODevice>
+#include <QList>
 #include <QObject>
 
 class QAbstractSocket;
 
 // CS_NAMESPACE_BEGIN
 // CS_EXPORT_BEGIN
+class ByteChain {
+public:
+    void       append(const QByteArray &block);
+    void       append(const char *data, int size);
+    int        size() const { return total; }
+    bool       isEmpty() const { return total == 0; }
+    void       clear();
+    QByteArray peek(int size = 0) const;
+    QByteArray take(int size = 0);
+    int        read(char *data, int maxSize);
+    void       skip(int size);
+
+private:
+    QList<QByteArray> chunks;
+    int               headOffset = 0; // consumed bytes of chunks.first()
+    int               total      = 0;
+};
+
 class ByteStream : public QIODevice {
     Q_OBJECT
 public:
@@ -62,8 +81,8 @@ protected:
     void        appendWrite(const QByteArray &);
     QByteArray  takeRead(int size = 0, bool del = true);
     QByteArray  takeWrite(int size = 0, bool del = true);
-    QByteArray &readBuf();
-    QByteArray &writeBuf();
+    ByteChain & readBuf();
+    ByteChain & writeBuf();
     virtual int tryWrite();
 
 private:
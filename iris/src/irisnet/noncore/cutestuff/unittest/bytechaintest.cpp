@@ -0,0 +1,140 @@
+/*
+ * bytechaintest.cpp - ByteChain tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "bytestream.h"
+#include "qttestutil/qttestutil.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+// CHAIN_MERGE_MAX in bytestream.cpp
+#define MERGE_MAX 512
+
+class ByteChainTest : public QObject {
+    Q_OBJECT
+
+private:
+    static QByteArray block(int size, char c) { return QByteArray(size, c); }
+
+    // a whole chunk is returned shared, so two peeks at it return the same memory
+    static bool isOneChunk(const ByteChain &chain, int size)
+    {
+        return chain.peek(size).constData() == chain.peek(size).constData();
+    }
+
+private slots:
+    void testWholeBlockIsShared()
+    {
+        ByteChain  chain;
+        QByteArray big = block(MERGE_MAX + 1, 'a');
+        chain.append(big);
+        QVERIFY(chain.peek(big.size()).constData() == big.constData());
+
+        // a small block after a big one gets its own chunk, the big one stays untouched
+        chain.append(block(10, 'b'));
+        QVERIFY(chain.peek(big.size()).constData() == big.constData());
+        QCOMPARE(chain.size(), MERGE_MAX + 11);
+    }
+
+    void testMergeThreshold()
+    {
+        ByteChain chain;
+        chain.append(block(MERGE_MAX, 'a'));
+        chain.append(block(1, 'b')); // the tail is not bigger than the limit yet
+        QVERIFY(isOneChunk(chain, MERGE_MAX + 1));
+
+        chain.append(block(1, 'c')); // now it is
+        QVERIFY(isOneChunk(chain, MERGE_MAX + 1));
+        QVERIFY(!isOneChunk(chain, MERGE_MAX + 2));
+
+        ByteChain  small;
+        QByteArray big = block(MERGE_MAX + 1, 'x');
+        small.append(block(10, 'a'));
+        small.append(big); // too big to be merged, even after a small tail
+        small.skip(10);
+        QVERIFY(small.peek().constData() == big.constData());
+
+        ByteChain raw;
+        raw.append("abc", 3);
+        raw.append("def", 3);
+        QVERIFY(isOneChunk(raw, 6));
+        QCOMPARE(raw.peek(), QByteArray("abcdef"));
+    }
+
+    void testPartialSkip()
+    {
+        ByteChain  chain;
+        QByteArray a = block(1000, 'a');
+        QByteArray b = QByteArray(1000, 'b') + QByteArray(1000, 'c');
+        chain.append(a);
+        chain.append(b);
+
+        chain.skip(1500); // into the middle of the second chunk
+        QCOMPARE(chain.size(), 1500);
+        QCOMPARE(chain.peek(10), b.mid(500, 10));
+        QCOMPARE(chain.peek(), b.mid(500));
+
+        chain.append(block(700, 'd'));
+        chain.skip(1499); // across the rest of b, leaving one byte of it
+        QCOMPARE(chain.size(), 701);
+        QCOMPARE(chain.take(2), QByteArray("cd"));
+        QCOMPARE(chain.peek(), block(699, 'd'));
+
+        chain.skip(10000);
+        QVERIFY(chain.isEmpty());
+        QCOMPARE(chain.peek(), QByteArray());
+    }
+
+    void testPeekAndTake()
+    {
+        ByteChain chain;
+        chain.append(block(600, 'a'));
+        chain.append(block(600, 'b'));
+
+        QCOMPARE(chain.peek(700), block(600, 'a') + block(100, 'b'));
+        QCOMPARE(chain.size(), 1200); // peek leaves everything in place
+        QCOMPARE(chain.peek(700), block(600, 'a') + block(100, 'b'));
+
+        QCOMPARE(chain.take(700), block(600, 'a') + block(100, 'b'));
+        QCOMPARE(chain.size(), 500);
+        QCOMPARE(chain.peek(), block(500, 'b'));
+
+        // more than available, or 0, means everything
+        QCOMPARE(chain.peek(5000).size(), 500);
+        QCOMPARE(chain.take().size(), 500);
+        QVERIFY(chain.isEmpty());
+    }
+
+    void testRead()
+    {
+        ByteChain chain;
+        chain.append(block(600, 'a'));
+        chain.append(block(600, 'b'));
+        chain.skip(100);
+
+        QByteArray buf(1000, 0);
+        QCOMPARE(chain.read(buf.data(), 600), 600);
+        QCOMPARE(buf.left(600), block(500, 'a') + block(100, 'b'));
+        QCOMPARE(chain.read(buf.data(), 1000), 500);
+        QCOMPARE(chain.read(buf.data(), 1000), 0);
+        QVERIFY(chain.isEmpty());
+    }
+};
+
+QTTESTUTIL_REGISTER_TEST(ByteChainTest);
+#include "bytechaintest.moc"
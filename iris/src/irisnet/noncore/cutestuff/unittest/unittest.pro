@@ -0,0 +1,5 @@
+include(../../../../../iris.pri)
+include(../../../../xmpp/qa/unittest.pri)
+include(unittest.pri)
+
+INCLUDEPATH += $$PWD/..
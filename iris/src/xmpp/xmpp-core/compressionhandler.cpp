@@ -31,14 +31,33 @@ void CompressionHandler::writeIncoming(const QByteArray &a)
         QTimer::singleShot(0, this, SIGNAL(error()));
 }
 
+// stanzas written during one event loop pass share one sync flush.  the
+//   output was never handed on before the next pass anyway, so this costs
+//   no latency but saves the flush marker and a partial block per stanza
 void CompressionHandler::write(const QByteArray &a)
 {
     // qDebug() << QString("CompressionHandler::write(%1)").arg(a.size());
     errorCode_ = compressor_->write(a);
+    if (errorCode_) {
+        QTimer::singleShot(0, this, SIGNAL(error()));
+        return;
+    }
+
+    pendingPlain_ += a.size();
+    if (!syncPending_) {
+        syncPending_ = true;
+        QTimer::singleShot(0, this, SLOT(sync()));
+    }
+}
+
+void CompressionHandler::sync()
+{
+    syncPending_ = false;
+    errorCode_   = compressor_->sync();
     if (!errorCode_)
-        QTimer::singleShot(0, this, SIGNAL(readyReadOutgoing()));
+        emit readyReadOutgoing();
     else
-        QTimer::singleShot(0, this, SIGNAL(error()));
+        emit error();
 }
 
 QByteArray CompressionHandler::read()
@@ -57,7 +76,8 @@ QByteArray CompressionHandler::readOutgoing(int *i)
     QByteArray b = outgoing_buffer_.buffer();
     outgoing_buffer_.buffer().clear();
     outgoing_buffer_.reset();
-    *i = b.size();
+    *i            = pendingPlain_;
+    pendingPlain_ = 0;
     return b;
 }
 
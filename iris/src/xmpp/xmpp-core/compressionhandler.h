@@ -24,11 +24,16 @@ signals:
     void readyReadOutgoing();
     void error();
 
+private slots:
+    void sync();
+
 private:
     ZLibCompressor *  compressor_;
     ZLibDecompressor *decompressor_;
     QBuffer           outgoing_buffer_, incoming_buffer_;
     int               errorCode_;
+    int               pendingPlain_ = 0; // bytes written since the last readOutgoing()
+    bool              syncPending_  = false;
 };
 
 #endif // COMPRESSIONHANDLER_H
@@ -179,6 +179,14 @@ void BasicProtocol::sendStanza(const QDomElement &e)
     sendList += i;
 }
 
+void BasicProtocol::sendStanza(const QDomElement &e, const QByteArray &data)
+{
+    SendItem i;
+    i.stanzaToSend = e;
+    i.stanzaData   = data;
+    sendList += i;
+}
+
 void BasicProtocol::sendDirect(const QString &s)
 {
     SendItem i;
@@ -521,7 +529,10 @@ bool BasicProtocol::doStep(const QDomElement &e)
             // outgoing stanza?
             if (!i.stanzaToSend.isNull()) {
                 ++stanzasPending;
-                writeElement(i.stanzaToSend, TypeStanza, true);
+                if (i.stanzaData.isEmpty())
+                    writeElement(i.stanzaToSend, TypeStanza, true);
+                else
+                    writeElement(i.stanzaToSend, i.stanzaData, TypeStanza, true);
                 event = ESend;
             }
             // direct send?
@@ -628,13 +639,18 @@ void CoreProtocol::needTimer(int seconds)
 
 void CoreProtocol::sendStanza(const QDomElement &e)
 {
-    if (sm.isActive()) {
-        int len = sm.addUnacknowledgedStanza(e);
-        if (len > 5 && len % 4 == 0)
-            if (needSMRequest())
-                event = ESend;
+    if (!sm.isActive()) {
+        BasicProtocol::sendStanza(e);
+        return;
     }
-    BasicProtocol::sendStanza(e);
+
+    // serialize once for both the wire and the resend queue
+    QByteArray data = elementToData(e);
+    int        len  = sm.addUnacknowledgedStanza(data);
+    if (len > 5 && len % 4 == 0)
+        if (needSMRequest())
+            event = ESend;
+    BasicProtocol::sendStanza(e, data);
 }
 
 void CoreProtocol::startClientOut(const Jid &_jid, bool _oldOnly, bool tlsActive, bool _doAuth, bool _doCompress)
@@ -1727,12 +1743,9 @@ bool CoreProtocol::normalStep(const QDomElement &e)
                 return true;
             } else if (e.localName() == "resumed") {
                 sm.resume(e.attribute("h").toUInt());
-                while (true) {
-                    QDomElement st = sm.getUnacknowledgedStanza();
-                    if (st.isNull())
-                        break;
-                    send(st);
-                }
+                QByteArray unacked = sm.unacknowledgedData();
+                if (!unacked.isEmpty())
+                    writeData(unacked, TypeElement, false);
                 needTimer(SM_TIMER_INTERVAL_SECS);
                 event = EReady;
                 step  = Done;
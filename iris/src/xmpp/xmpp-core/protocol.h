@@ -44,6 +44,8 @@
 #define NS_COMPRESS_FEATURE "http://jabber.org/features/compress"
 #define NS_COMPRESS_PROTOCOL "http://jabber.org/protocol/compress"
 #define NS_HOSTS "http://barracuda.com/xmppextensions/hosts"
+#define NS_ROSTER_VER "urn:xmpp:features:rosterver"
+#define NS_CSI "urn:xmpp:csi:0"
 
 namespace XMPP {
 class Version {
@@ -190,6 +192,7 @@ protected:
     static QString saslCondToString(int);
     static QString streamCondToString(int);
 
+    void sendStanza(const QDomElement &e, const QByteArray &data);
     void send(const QDomElement &e, bool clip = false);
     void sendUrgent(const QDomElement &e, bool clip = false);
     void sendStreamError(int cond, const QString &text = "", const QDomElement &appSpec = QDomElement());
@@ -237,6 +240,7 @@ private:
 
     struct SendItem {
         QDomElement stanzaToSend;
+        QByteArray  stanzaData; // stanzaToSend already serialized, if not empty
         QString     stringToSend;
         bool        doWhitespace;
     };
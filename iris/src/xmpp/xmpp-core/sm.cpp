@@ -19,12 +19,122 @@
 
 #include "sm.h"
 
-#ifdef IRIS_SM_DEBUG
 #include <QDebug>
-#endif
+#include <QDir>
+#include <QTemporaryFile>
 
 using namespace XMPP;
 
+SMSendQueue::SMSendQueue() { }
+
+SMSendQueue::~SMSendQueue() { }
+
+void SMSendQueue::clear()
+{
+    buffer_.clear();
+    sizes_.clear();
+    head_ = 0;
+    end_  = 0;
+    spill_.reset();
+}
+
+void SMSendQueue::setSpill(const QString &dir, qint64 bytes)
+{
+    spillDir_  = dir;
+    spillSize_ = dir.isEmpty() ? 0 : bytes;
+}
+
+void SMSendQueue::enqueue(const QByteArray &stanza)
+{
+    if (spill_) {
+        // data() moves the file position, otherwise we are still at the end
+        if ((spill_->pos() == end_ || spill_->seek(end_)) && spill_->write(stanza) == stanza.size()) {
+            sizes_.enqueue(stanza.size());
+            end_ += stanza.size();
+            return;
+        }
+        qWarning("Stream Management: failed to write the send queue to %s: %s", qPrintable(spill_->fileName()),
+                 qPrintable(spill_->errorString()));
+        buffer_ = data();
+        head_   = 0;
+        end_    = buffer_.size();
+        spill_.reset();
+    }
+
+    buffer_.append(stanza);
+    sizes_.enqueue(stanza.size());
+    end_ += stanza.size();
+    if (spillSize_ > 0 && byteSize() > spillSize_)
+        spill();
+}
+
+void SMSendQueue::dequeue()
+{
+    if (sizes_.isEmpty())
+        return;
+    head_ += sizes_.dequeue();
+    if (sizes_.isEmpty())
+        clear();
+    else if (spill_)
+        unspill();
+    else
+        compact();
+}
+
+QByteArray SMSendQueue::data() const
+{
+    if (!spill_)
+        return buffer_.mid(int(head_));
+    if (!spill_->seek(head_)) {
+        qWarning("Stream Management: failed to read the send queue from %s", qPrintable(spill_->fileName()));
+        return QByteArray();
+    }
+    return spill_->read(end_ - head_);
+}
+
+void SMSendQueue::spill()
+{
+    // the queue is plain text of the conversation, so keep it private to the user
+    auto             file    = std::make_unique<QTemporaryFile>(QDir(spillDir_).filePath("sm-queue-XXXXXX"));
+    const QByteArray pending = buffer_.mid(int(head_));
+    if (!QDir().mkpath(spillDir_) || !file->open()
+        || !file->setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner)
+        || file->write(pending) != pending.size()) {
+        qWarning("Stream Management: failed to spill the send queue: %s", qPrintable(file->errorString()));
+        spillSize_ = 0; // don't retry on every stanza
+        return;
+    }
+    spill_ = std::move(file);
+    buffer_.clear();
+    end_ -= head_;
+    head_ = 0;
+}
+
+void SMSendQueue::unspill()
+{
+    // go back to memory well below the spill size, so a queue hovering
+    // around it doesn't flip between the two on every stanza
+    if (spillSize_ > 0 && byteSize() * 2 > spillSize_)
+        return;
+    QByteArray pending = data();
+    if (pending.size() != byteSize())
+        return; // read failed, keep using the file
+    spill_.reset();
+    buffer_ = pending;
+    end_    = buffer_.size();
+    head_   = 0;
+}
+
+void SMSendQueue::compact()
+{
+    // drop acknowledged data once it takes the larger part of the buffer
+    if (head_ < 4096 || head_ * 2 < buffer_.size())
+        return;
+    buffer_.remove(0, int(head_));
+    end_ -= head_;
+    head_ = 0;
+}
+
 SMState::SMState()
 {
     enabled = false;
@@ -42,7 +152,7 @@ void SMState::resetCounters()
 }
 
 StreamManagement::StreamManagement(QObject *parent) :
-    QObject(parent), sm_started(false), sm_resumed(false), sm_stanzas_notify(0), sm_resend_pos(0)
+    QObject(parent), sm_started(false), sm_resumed(false), sm_stanzas_notify(0)
 {
 }
 
@@ -51,7 +161,6 @@ void StreamManagement::reset()
     sm_started                     = false;
     sm_resumed                     = false;
     sm_stanzas_notify              = 0;
-    sm_resend_pos                  = 0;
     sm_timeout_data.elapsed_timer  = QElapsedTimer();
     sm_timeout_data.waiting_answer = false;
 }
@@ -67,8 +176,7 @@ void StreamManagement::start(const QString &resumption_id)
 
 void StreamManagement::resume(quint32 last_handled)
 {
-    sm_resumed    = true;
-    sm_resend_pos = 0;
+    sm_resumed = true;
     processAcknowledgement(last_handled);
     sm_timeout_data.waiting_answer = false;
     sm_timeout_data.elapsed_timer.start();
@@ -107,16 +215,11 @@ void StreamManagement::countInputRawData(int bytes)
     }
 }
 
-QDomElement StreamManagement::getUnacknowledgedStanza()
-{
-    if (sm_resend_pos < state_.send_queue.size())
-        return state_.send_queue.at(sm_resend_pos++);
-    return QDomElement();
-}
+QByteArray StreamManagement::unacknowledgedData() const { return state_.send_queue.data(); }
 
-int StreamManagement::addUnacknowledgedStanza(const QDomElement &e)
+int StreamManagement::addUnacknowledgedStanza(const QByteArray &data)
 {
-    state_.send_queue.enqueue(e);
+    state_.send_queue.enqueue(data);
     int len = state_.send_queue.length();
 #ifdef IRIS_SM_DEBUG
     qDebug() << "Stream Management: [INF] Send queue length is changed: " << len;
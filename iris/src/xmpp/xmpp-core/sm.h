@@ -25,12 +25,56 @@
 #include <QObject>
 #include <QQueue>
 
+#include <memory>
+
+class QTemporaryFile;
+
 #define NS_STREAM_MANAGEMENT "urn:xmpp:sm:3"
 #define SM_TIMER_INTERVAL_SECS 40
+#define SM_QUEUE_SPILL_SIZE (1024 * 1024) /* bytes, suggested threshold for setSpill() */
 
 //#define IRIS_SM_DEBUG
 
 namespace XMPP {
+/*
+ * Unacknowledged outgoing stanzas, kept as the UTF-8 data already written
+ * to the stream. The data lives in one contiguous buffer with the stanza
+ * sizes kept aside, so acknowledgements only move the head and resending
+ * is a single write. Spilling is off by default: once enabled with
+ * setSpill() and the buffer grows over the spill size, it is moved to an
+ * owner-only temporary file in the given directory until the queue drains.
+ */
+class SMSendQueue {
+public:
+    SMSendQueue();
+    ~SMSendQueue();
+
+    bool       isEmpty() const { return sizes_.isEmpty(); }
+    int        length() const { return sizes_.size(); }
+    qint64     byteSize() const { return end_ - head_; }
+    bool       isSpilled() const { return bool(spill_); }
+    void       setSpill(const QString &dir, qint64 bytes); // 0 bytes or an empty dir disables spilling
+    void       clear();
+    void       enqueue(const QByteArray &stanza);
+    void       dequeue();
+    QByteArray data() const;
+
+private:
+    void spill();
+    void unspill();
+    void compact();
+
+    QByteArray                      buffer_;
+    QQueue<int>                     sizes_;
+    qint64                          head_      = 0; // offset of the first queued stanza
+    qint64                          end_       = 0; // offset past the last queued stanza
+    qint64                          spillSize_ = 0;
+    QString                         spillDir_;
+    std::unique_ptr<QTemporaryFile> spill_;
+
+    Q_DISABLE_COPY(SMSendQueue)
+};
+
 class SMState {
 public:
     SMState();
@@ -44,7 +88,7 @@ public:
     bool                enabled;
     quint32             received_count;
     quint32             server_last_handled;
-    QQueue<QDomElement> send_queue;
+    SMSendQueue         send_queue;
     QString             resumption_id;
     struct {
         QString host;
@@ -66,8 +110,8 @@ public:
     int                  lastAckElapsed() const;
     int                  takeAckedCount();
     void                 countInputRawData(int bytes);
-    QDomElement          getUnacknowledgedStanza();
-    int                  addUnacknowledgedStanza(const QDomElement &e);
+    QByteArray           unacknowledgedData() const;
+    int                  addUnacknowledgedStanza(const QByteArray &data);
     void                 processAcknowledgement(quint32 last_handled);
     void                 markStanzaHandled();
     QDomElement          generateRequestStanza(QDomDocument &doc);
@@ -78,7 +122,6 @@ private:
     bool    sm_started;
     bool    sm_resumed;
     int     sm_stanzas_notify;
-    int     sm_resend_pos;
     struct {
         QElapsedTimer elapsed_timer;
         bool          waiting_answer = false;
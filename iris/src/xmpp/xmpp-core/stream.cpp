@@ -48,12 +48,15 @@
 #include "protocol.h"
 #include "securestream.h"
 #include "simplesasl.h"
+#include "xmpp_streamcapture.h"
 #ifdef XMPP_TEST
 #include "td.h"
 #endif
 
 #include <QByteArray>
+#include <QDateTime>
 #include <QList>
+#include <QMetaMethod>
 #include <QPointer>
 #include <QTextStream>
 #include <QTimer>
@@ -157,15 +160,16 @@ public:
 
     bool in_rrsig = false;
 
-    Connector    *conn       = nullptr;
-    ByteStream   *bs         = nullptr;
-    TLSHandler   *tlsHandler = nullptr;
-    QCA::TLS     *tls        = nullptr;
-    QCA::SASL    *sasl       = nullptr;
-    SecureStream *ss         = nullptr;
-    CoreProtocol  client;
-    CoreProtocol  srv;
-    QString       lang;
+    Connector     *conn       = nullptr;
+    ByteStream    *bs         = nullptr;
+    TLSHandler    *tlsHandler = nullptr;
+    QCA::TLS      *tls        = nullptr;
+    QCA::SASL     *sasl       = nullptr;
+    SecureStream  *ss         = nullptr;
+    StreamCapture *capture    = nullptr;
+    CoreProtocol   client;
+    CoreProtocol   srv;
+    QString        lang;
 
     QString defRealm;
 
@@ -569,6 +573,8 @@ void ClientStream::cr_connected()
         d->using_tls = true;
         d->ss->startTLSClient(d->tlsHandler, d->server, spare);
     } else {
+        if (d->capture && !spare.isEmpty())
+            d->capture->capture(StreamCapture::Incoming, QDateTime::currentMSecsSinceEpoch(), spare);
         d->client.addIncomingData(spare);
         processNext();
     }
@@ -605,6 +611,8 @@ void ClientStream::ss_readyRead()
 #endif
 
     if (d->mode == Client) {
+        if (d->capture)
+            d->capture->capture(StreamCapture::Incoming, QDateTime::currentMSecsSinceEpoch(), a);
         d->client.addIncomingData(a);
         d->client.sm.countInputRawData(a.size());
     } else {
@@ -882,9 +890,11 @@ void ClientStream::processNext()
         qDebug("Processing step...\n");
 #endif
         bool ok = d->client.processStep();
-        // deal with send/received items
+        // deal with send/received items. serializing them is expensive, so only when somebody listens
+        const bool traceIn  = isSignalConnected(QMetaMethod::fromSignal(&ClientStream::incomingXml));
+        const bool traceOut = isSignalConnected(QMetaMethod::fromSignal(&ClientStream::outgoingXml));
         for (const XmlProtocol::TransferItem &i : qAsConst(d->client.transferItemList)) {
-            if (i.isExternal)
+            if (i.isExternal || !(i.isSent ? traceOut : traceIn))
                 continue;
             QString str;
             if (i.isString) {
@@ -949,6 +959,8 @@ void ClientStream::processNext()
 #ifdef XMPP_DEBUG
                 qDebug("Need Send: {%s}\n", a.data());
 #endif
+                if (d->capture)
+                    d->capture->capture(StreamCapture::Outgoing, QDateTime::currentMSecsSinceEpoch(), a);
                 d->ss->write(a);
             }
             break;
@@ -1509,6 +1521,13 @@ bool ClientStream::isResumed() const { return d->client.sm.isResumed(); }
 
 void ClientStream::setSMEnabled(bool e) { d->client.sm.state().setEnabled(e); }
 
+void ClientStream::setSMSpill(const QString &dir, qint64 bytes)
+{
+    d->client.sm.state().send_queue.setSpill(dir, bytes);
+}
+
+void ClientStream::setCapture(StreamCapture *capture) { d->capture = capture; }
+
 void ClientStream::setTimer(int secs)
 {
     d->timeout_timer.setSingleShot(true);
@@ -0,0 +1,117 @@
+/*
+ * smtest.cpp - Stream Management send queue tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "qttestutil/qttestutil.h"
+#include "sm.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+using namespace XMPP;
+
+class SMTest : public QObject {
+    Q_OBJECT
+
+private:
+    static QByteArray stanza(int n) { return QString("<message id='m%1'><body>%1</body></message>").arg(n).toUtf8(); }
+
+    static QByteArray stanzas(int from, int to)
+    {
+        QByteArray ret;
+        for (int i = from; i <= to; ++i)
+            ret += stanza(i);
+        return ret;
+    }
+
+private slots:
+    void testSpillIsOffByDefault()
+    {
+        SMSendQueue q;
+        for (int i = 0; q.byteSize() <= SM_QUEUE_SPILL_SIZE; ++i)
+            q.enqueue(stanza(i));
+        QVERIFY(!q.isSpilled());
+    }
+
+    void testSpillAndDrain()
+    {
+        QTemporaryDir tmp;
+        QVERIFY(tmp.isValid());
+        QString dir = tmp.path() + "/sm";
+
+        SMSendQueue q;
+        q.setSpill(dir, stanza(1).size() * 4);
+        for (int i = 1; i <= 10; ++i)
+            q.enqueue(stanza(i));
+        QVERIFY(q.isSpilled());
+        QCOMPARE(q.length(), 10);
+        QCOMPARE(q.data(), stanzas(1, 10));
+
+        // the spill file is in the given directory and readable by the owner only
+        const QFileInfoList files = QDir(dir).entryInfoList(QDir::Files);
+        QCOMPARE(files.size(), 1);
+        QCOMPARE(files.first().permissions() & (QFileDevice::ReadGroup | QFileDevice::ReadOther),
+                 QFileDevice::Permissions());
+
+        // appending after a read keeps the order
+        q.enqueue(stanza(11));
+        QCOMPARE(q.data(), stanzas(1, 11));
+
+        // back in memory once well below the threshold, and the file is gone
+        for (int i = 1; i <= 10; ++i)
+            q.dequeue();
+        QVERIFY(!q.isSpilled());
+        QCOMPARE(q.data(), stanza(11));
+        QVERIFY(QDir(dir).entryInfoList(QDir::Files).isEmpty());
+    }
+
+    void testResumeReplaysInOrder()
+    {
+        QTemporaryDir tmp;
+        QVERIFY(tmp.isValid());
+
+        StreamManagement sm;
+        sm.state().setEnabled(true);
+        sm.start("resume-id");
+        sm.state().send_queue.setSpill(tmp.path(), stanza(1).size() * 4);
+
+        for (int i = 1; i <= 6; ++i)
+            sm.addUnacknowledgedStanza(stanza(i));
+        sm.processAcknowledgement(2);
+        QVERIFY(sm.state().send_queue.isSpilled());
+
+        // stanzas written while the connection was down
+        for (int i = 7; i <= 9; ++i)
+            sm.addUnacknowledgedStanza(stanza(i));
+
+        // the server saw up to 4 before the connection broke, the rest is resent as is
+        sm.resume(4);
+        QVERIFY(sm.isResumed());
+        QCOMPARE(sm.state().send_queue.length(), 5);
+        QCOMPARE(sm.unacknowledgedData(), stanzas(5, 9));
+
+        sm.processAcknowledgement(9);
+        QVERIFY(sm.state().send_queue.isEmpty());
+        QVERIFY(sm.unacknowledgedData().isEmpty());
+    }
+};
+
+QTTESTUTIL_REGISTER_TEST(SMTest);
+#include "smtest.moc"
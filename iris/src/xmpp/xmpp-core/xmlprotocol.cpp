@@ -410,6 +410,12 @@ QString XmlProtocol::elementToString(const QDomElement &e, bool clip)
     return sanitizeForStream(xmlToString(e, ns, qn, clip));
 }
 
+// the exact bytes writeElement() puts on the wire
+QByteArray XmlProtocol::elementToData(const QDomElement &e, bool clip)
+{
+    return sanitizeForStream(elementToString(e, clip)).toUtf8();
+}
+
 bool XmlProtocol::stepRequiresElement() const
 {
     // default returns false
@@ -471,11 +477,21 @@ int XmlProtocol::writeElement(const QDomElement &e, int id, bool external, bool
 {
     if (e.isNull())
         return 0;
+    return writeElement(e, elementToData(e, clip), id, external, urgent);
+}
+
+int XmlProtocol::writeElement(const QDomElement &e, const QByteArray &data, int id, bool external, bool urgent)
+{
     transferItemList += TransferItem(e, true, external);
 
     // elementSend(e);
-    QString out = sanitizeForStream(elementToString(e, clip));
-    return internalWriteString(out, TrackItem::Custom, id, urgent);
+    return internalWriteData(data, TrackItem::Custom, id, urgent);
+}
+
+int XmlProtocol::writeData(const QByteArray &data, int id, bool external)
+{
+    transferItemList += TransferItem(QString::fromUtf8(data), true, external);
+    return internalWriteData(data, TrackItem::Custom, id);
 }
 
 QByteArray XmlProtocol::resetStream()
@@ -75,6 +75,7 @@ public:
     inline bool isIncoming() const { return incoming; }
     QString     xmlEncoding() const;
     QString     elementToString(const QDomElement &e, bool clip = false);
+    QByteArray  elementToData(const QDomElement &e, bool clip = false);
 
     class TransferItem {
     public:
@@ -112,6 +113,8 @@ protected:
     bool       close();
     int        writeString(const QString &s, int id, bool external);
     int        writeElement(const QDomElement &e, int id, bool external, bool clip = false, bool urgent = false);
+    int        writeElement(const QDomElement &e, const QByteArray &data, int id, bool external, bool urgent = false);
+    int        writeData(const QByteArray &data, int id, bool external);
     QByteArray resetStream();
 
 private:
@@ -33,6 +33,7 @@ class QString;
 
 namespace XMPP {
 class Connector;
+class StreamCapture;
 class StreamFeatures;
 class TLSHandler;
 
@@ -155,10 +156,12 @@ public:
     // extra
     void writeDirect(const QString &s);
     void setNoopTime(int mills);
+    void setCapture(StreamCapture *capture); // not owned, nullptr stops capturing
 
     // Stream management
     bool isResumed() const;
     void setSMEnabled(bool enable);
+    void setSMSpill(const QString &dir, qint64 bytes); // keep larger unacked queues in dir, 0 bytes disables
 
     // barracuda extension
     QStringList hosts() const;
@@ -0,0 +1,103 @@
+/*
+ * xmpp_streamcapture.cpp - recording and replay of raw XMPP stream data
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "xmpp_streamcapture.h"
+
+#include <QIODevice>
+
+#include <cstring>
+
+namespace XMPP {
+static const char captureMagic[]   = "XMPPCAP1";
+static const int  captureMagicSize = sizeof(captureMagic) - 1;
+
+StreamCapture::~StreamCapture() { }
+
+//----------------------------------------------------------------------------
+// StreamCaptureWriter
+//----------------------------------------------------------------------------
+StreamCaptureWriter::StreamCaptureWriter(QIODevice *device) : stream_(device)
+{
+    stream_.setVersion(QDataStream::Qt_5_0);
+    valid_ = device->isWritable() && stream_.writeRawData(captureMagic, captureMagicSize) == captureMagicSize;
+}
+
+void StreamCaptureWriter::capture(Direction direction, qint64 timestamp, const QByteArray &data)
+{
+    if (!valid_)
+        return;
+    stream_ << quint8(direction) << timestamp << data;
+    if (stream_.status() != QDataStream::Ok) {
+        qWarning("StreamCapture: failed to write the capture, recording stopped");
+        valid_ = false;
+    }
+}
+
+//----------------------------------------------------------------------------
+// StreamCaptureReader
+//----------------------------------------------------------------------------
+StreamCaptureReader::StreamCaptureReader(QIODevice *device) : stream_(device)
+{
+    stream_.setVersion(QDataStream::Qt_5_0);
+    char magic[captureMagicSize];
+    valid_ = stream_.readRawData(magic, captureMagicSize) == captureMagicSize
+        && memcmp(magic, captureMagic, captureMagicSize) == 0;
+}
+
+bool StreamCaptureReader::atEnd() const { return !valid_ || stream_.atEnd(); }
+
+bool StreamCaptureReader::readRecord(Record &record)
+{
+    if (atEnd())
+        return false;
+
+    quint8 direction;
+    stream_ >> direction >> record.timestamp >> record.data;
+    if (stream_.status() != QDataStream::Ok || direction > StreamCapture::Outgoing) {
+        valid_ = false;
+        return false;
+    }
+    record.direction = StreamCapture::Direction(direction);
+    return true;
+}
+
+int StreamCaptureReader::replayIncoming(const std::function<void(const Parser::Event &)> &handler)
+{
+    Parser parser;
+    bool   opened = false;
+    int    count  = 0;
+    Record record;
+    while (readRecord(record)) {
+        if (record.direction != StreamCapture::Incoming)
+            continue;
+        // a stream restart (after STARTTLS, SASL or compression) begins with a new header
+        if (opened && record.data.trimmed().startsWith("<?xml")) {
+            parser.reset();
+            opened = false;
+        }
+        parser.appendData(record.data);
+        for (Parser::Event e = parser.readNext(); !e.isNull(); e = parser.readNext()) {
+            opened = opened || e.type() == Parser::Event::DocumentOpen;
+            ++count;
+            if (handler)
+                handler(e);
+        }
+    }
+    return count;
+}
+} // namespace XMPP
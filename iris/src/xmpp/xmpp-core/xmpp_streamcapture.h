@@ -0,0 +1,86 @@
+/*
+ * xmpp_streamcapture.h - recording and replay of raw XMPP stream data
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef XMPP_STREAMCAPTURE_H
+#define XMPP_STREAMCAPTURE_H
+
+#include "parser.h"
+
+#include <QByteArray>
+#include <QDataStream>
+
+#include <functional>
+
+class QIODevice;
+
+namespace XMPP {
+/*
+ * Receives the plain (decrypted, uncompressed) stream data as it is read
+ * from and written to the wire. ClientStream calls it only when a capture
+ * is installed, so there is no cost otherwise.
+ */
+class StreamCapture {
+public:
+    enum Direction { Incoming, Outgoing };
+
+    virtual ~StreamCapture();
+    virtual void capture(Direction direction, qint64 timestamp, const QByteArray &data) = 0; // msecs since epoch
+};
+
+/*
+ * Capture file layout: the "XMPPCAP1" magic followed by records of
+ * direction (quint8), timestamp (qint64, msecs since epoch) and data
+ * (QByteArray), all in big endian QDataStream encoding.
+ */
+class StreamCaptureWriter : public StreamCapture {
+public:
+    StreamCaptureWriter(QIODevice *device);
+
+    bool isValid() const { return valid_; }
+    void capture(Direction direction, qint64 timestamp, const QByteArray &data) override;
+
+private:
+    QDataStream stream_;
+    bool        valid_;
+};
+
+class StreamCaptureReader {
+public:
+    struct Record {
+        StreamCapture::Direction direction = StreamCapture::Incoming;
+        qint64                   timestamp = 0;
+        QByteArray               data;
+    };
+
+    StreamCaptureReader(QIODevice *device);
+
+    bool isValid() const { return valid_; }
+    bool atEnd() const;
+    bool readRecord(Record &record);
+
+    // feeds the incoming side through a parser the way XmlProtocol does,
+    // restarting it on each new stream header. returns the number of events.
+    int replayIncoming(const std::function<void(const Parser::Event &)> &handler = nullptr);
+
+private:
+    QDataStream stream_;
+    bool        valid_;
+};
+} // namespace XMPP
+
+#endif // XMPP_STREAMCAPTURE_H
@@ -88,6 +88,7 @@
 
 #include <QList>
 #include <QMap>
+#include <QMetaMethod>
 #include <QObject>
 #include <QPointer>
 #include <QTimer>
@@ -130,6 +131,20 @@ public:
     bool                    useTzoffset      = false; // manual tzoffset is old way of doing utc<->local translations
     bool                    active           = false;
     bool                    capsOptimization = false; // don't send caps every time
+    bool                    clientActive     = true;  // XEP-0352 state wanted by the application
+    bool                    csiActive        = true;  // XEP-0352 state known to the server
+
+    bool hasStreamFeature(const QString &name, const QString &ns) const
+    {
+        if (!stream)
+            return false;
+        const auto features = stream->unhandledFeatures();
+        for (const QDomElement &e : features) {
+            if (e.localName() == name && e.namespaceURI() == ns)
+                return true;
+        }
+        return false;
+    }
 
     LiveRoster                roster;
     ResourceList              resourceList;
@@ -202,6 +217,7 @@ Client::~Client()
     delete d->jingleManager;
     delete d->root;
     delete d;
+    d = nullptr; // disconnectNotify() may still come while QObject tears down
     // fprintf(stderr, "\tClient::~Client\n");
 }
 
@@ -214,9 +230,8 @@ void Client::connectToServer(ClientStream *s, const Jid &j, bool auth)
     // connect(d->stream, SIGNAL(sslCertificateReady(QSSLCert)), SLOT(streamSSLCertificateReady(QSSLCert)));
     connect(d->stream, SIGNAL(readyRead()), SLOT(streamReadyRead()));
     // connect(d->stream, SIGNAL(closeFinished()), SLOT(streamCloseFinished()));
-    connect(d->stream, SIGNAL(incomingXml(QString)), SLOT(streamIncomingXml(QString)));
-    connect(d->stream, SIGNAL(outgoingXml(QString)), SLOT(streamOutgoingXml(QString)));
     connect(d->stream, SIGNAL(haveUnhandledFeatures()), SLOT(parseUnhandledStreamFeatures()));
+    updateXmlTracing();
 
     d->stream->connectToServer(j, auth);
 }
@@ -224,10 +239,11 @@ void Client::connectToServer(ClientStream *s, const Jid &j, bool auth)
 void Client::start(const QString &host, const QString &user, const QString &pass, const QString &_resource)
 {
     // TODO
-    d->host     = host;
-    d->user     = user;
-    d->pass     = pass;
-    d->resource = _resource;
+    d->host      = host;
+    d->user      = user;
+    d->pass      = pass;
+    d->resource  = _resource;
+    d->csiActive = true; // new session is always active
 
     Status stat;
     stat.setIsAvailable(false);
@@ -521,11 +537,14 @@ void Client::streamReadyRead()
     while (d->stream && d->stream->stanzaAvailable()) {
         Stanza s = d->stream->read();
 
-        QString out = s.toString();
-        debug(QString("Client: incoming: [\n%1]\n").arg(out));
-        emit xmlIncoming(out);
+        if (isTracing(true)) {
+            QString out = s.toString();
+            debug(QString("Client: incoming: [\n%1]\n").arg(out));
+            emit xmlIncoming(out);
+        }
 
         QDomElement x = s.element(); // oldStyleNS(s.element());
+        emit        stanzaIncoming(x);
         distribute(x);
     }
 }
@@ -546,6 +565,43 @@ void Client::streamOutgoingXml(const QString &s)
     emit xmlOutgoing(str);
 }
 
+void Client::connectNotify(const QMetaMethod &signal)
+{
+    if (signal == QMetaMethod::fromSignal(&Client::xmlIncoming)
+        || signal == QMetaMethod::fromSignal(&Client::xmlOutgoing))
+        updateXmlTracing();
+}
+
+void Client::disconnectNotify(const QMetaMethod &signal)
+{
+    // invalid when disconnecting everything at once
+    if (!signal.isValid() || signal == QMetaMethod::fromSignal(&Client::xmlIncoming)
+        || signal == QMetaMethod::fromSignal(&Client::xmlOutgoing))
+        updateXmlTracing();
+}
+
+// The stream only serializes its traffic for the console when somebody
+// listens, so keep its trace signals connected just as long as ours are.
+void Client::updateXmlTracing()
+{
+    if (!d || !d->stream)
+        return;
+
+    disconnect(d->stream, &ClientStream::incomingXml, this, &Client::streamIncomingXml);
+    disconnect(d->stream, &ClientStream::outgoingXml, this, &Client::streamOutgoingXml);
+    if (isSignalConnected(QMetaMethod::fromSignal(&Client::xmlIncoming)))
+        connect(d->stream, &ClientStream::incomingXml, this, &Client::streamIncomingXml);
+    if (isSignalConnected(QMetaMethod::fromSignal(&Client::xmlOutgoing)))
+        connect(d->stream, &ClientStream::outgoingXml, this, &Client::streamOutgoingXml);
+}
+
+bool Client::isTracing(bool incoming) const
+{
+    return isSignalConnected(incoming ? QMetaMethod::fromSignal(&Client::xmlIncoming)
+                                      : QMetaMethod::fromSignal(&Client::xmlOutgoing))
+        || isSignalConnected(QMetaMethod::fromSignal(&Client::debugText));
+}
+
 void Client::parseUnhandledStreamFeatures()
 {
     QList<QDomElement> nl = d->stream->unhandledFeatures();
@@ -633,10 +689,13 @@ void Client::send(const QDomElement &x)
     if (e.isNull()) {              // so it was changed by signal above
         return;
     }
-    QString out = s.toString();
-    // qWarning() << "Out: " << out;
-    debug(QString("Client: outgoing: [\n%1]\n").arg(out));
-    emit xmlOutgoing(out);
+    if (isTracing(false)) {
+        QString out = s.toString();
+        // qWarning() << "Out: " << out;
+        debug(QString("Client: outgoing: [\n%1]\n").arg(out));
+        emit xmlOutgoing(out);
+    }
+    emit stanzaOutgoing(s.element());
 
     // printf("x[%s] x2[%s] s[%s]\n", Stream::xmlToString(x).toLatin1(), Stream::xmlToString(e).toLatin1(),
     // s.toString().toLatin1());
@@ -648,8 +707,10 @@ void Client::send(const QString &str)
     if (!d->stream)
         return;
 
-    debug(QString("Client: outgoing: [\n%1]\n").arg(str));
-    emit xmlOutgoing(str);
+    if (isTracing(false)) {
+        debug(QString("Client: outgoing: [\n%1]\n").arg(str));
+        emit xmlOutgoing(str);
+    }
     static_cast<ClientStream *>(d->stream)->writeDirect(str);
 }
 
@@ -878,14 +939,72 @@ void Client::pmMessage(const Message &m)
 
 void Client::prRoster(const Roster &r) { importRoster(r); }
 
+/**
+ * \brief Restores roster cached from previous sessions.
+ * Has to be called before the first rosterRequest(). If the cached roster has a version and
+ * the server supports roster versioning, the server will send only changes since that version.
+ * No signals are emitted for restored items.
+ */
+void Client::setCachedRoster(const Roster &r)
+{
+    if (!d->roster.isEmpty())
+        return;
+
+    for (const auto &item : r) {
+        d->roster += LiveRosterItem(item);
+    }
+    d->roster.setVersion(r.version());
+}
+
+bool Client::isRosterVersioningSupported() const
+{
+    return d->hasStreamFeature(QStringLiteral("ver"), QStringLiteral(NS_ROSTER_VER));
+}
+
+/**
+ * \brief Checks if the server supports XEP-0352 Client State Indication
+ */
+bool Client::isClientStateIndicationSupported() const
+{
+    return d->hasStreamFeature(QStringLiteral("csi"), QStringLiteral(NS_CSI));
+}
+
+/**
+ * \brief Tells the server if the user is interacting with the client (XEP-0352).
+ * While inactive the server may delay or drop presences and chat states.
+ * The state is sent when the session is active and it's resent by sendClientState() for new sessions.
+ */
+void Client::setClientActive(bool active)
+{
+    d->clientActive = active;
+    sendClientState();
+}
+
+bool Client::isClientActive() const { return d->clientActive; }
+
+void Client::sendClientState()
+{
+    if (!d->active || d->csiActive == d->clientActive || !isClientStateIndicationSupported())
+        return;
+
+    d->csiActive = d->clientActive;
+    // it's a nonza. so it's sent directly to not be counted by stream management
+    send(QString::fromLatin1("<%1 xmlns='" NS_CSI "'/>").arg(d->clientActive ? "active" : "inactive"));
+}
+
 void Client::rosterRequest(bool withGroupsDelimiter)
 {
     if (!d->active)
         return;
 
+    // XEP-0237: empty version means we want versioning but don't have any cached roster
+    QString version;
+    if (isRosterVersioningSupported())
+        version = d->roster.version().isEmpty() ? QString(QLatin1String("")) : d->roster.version();
+
     JT_Roster *r = new JT_Roster(rootTask());
     if (withGroupsDelimiter) {
-        connect(r, &JT_Roster::finished, this, [this, r]() mutable {
+        connect(r, &JT_Roster::finished, this, [this, r, version]() mutable {
             if (r->success()) {
                 d->roster.setGroupsDelimiter(r->groupsDelimiter());
                 emit rosterGroupsDelimiterRequestFinished(r->groupsDelimiter());
@@ -893,7 +1012,7 @@ void Client::rosterRequest(bool withGroupsDelimiter)
 
             r = new JT_Roster(rootTask());
             connect(r, SIGNAL(finished()), SLOT(slotRosterRequestFinished()));
-            r->get();
+            r->get(version);
             d->roster.flagAllForDelete(); // mod_groups patch
             r->go(true);
         });
@@ -903,7 +1022,7 @@ void Client::rosterRequest(bool withGroupsDelimiter)
         r->setTimeout(GROUPS_DELIMITER_TIMEOUT);
     } else {
         connect(r, SIGNAL(finished()), SLOT(slotRosterRequestFinished()));
-        r->get();
+        r->get(version);
         d->roster.flagAllForDelete(); // mod_groups patch
     }
 
@@ -914,7 +1033,11 @@ void Client::slotRosterRequestFinished()
 {
     JT_Roster *r = static_cast<JT_Roster *>(sender());
     // on success, let's take it
-    if (r->success()) {
+    if (r->success() && r->isRosterUnchanged()) {
+        // our roster is up to date. the server will push changes if any
+        for (auto &i : d->roster)
+            i.setFlagForDelete(false);
+    } else if (r->success()) {
         // d->roster.flagAllForDelete(); // mod_groups patch
 
         importRoster(r->roster());
@@ -943,6 +1066,8 @@ void Client::importRoster(const Roster &r)
     for (const auto &item : r) {
         importRosterItem(item);
     }
+    if (!r.version().isNull())
+        d->roster.setVersion(r.version());
     emit endImportRoster();
 }
 
@@ -1281,12 +1406,14 @@ void LiveRosterItem::setFlagForDelete(bool b) { v_flagForDelete = b; }
 class LiveRoster::Private {
 public:
     QString groupsDelimiter;
+    QString version;
 };
 
 LiveRoster::LiveRoster() : QList<LiveRosterItem>(), d(new LiveRoster::Private) { }
 LiveRoster::LiveRoster(const LiveRoster &other) : QList<LiveRosterItem>(other), d(new LiveRoster::Private)
 {
     d->groupsDelimiter = other.d->groupsDelimiter;
+    d->version         = other.d->version;
 }
 
 LiveRoster::~LiveRoster() { delete d; }
@@ -1295,6 +1422,7 @@ LiveRoster &LiveRoster::operator=(const LiveRoster &other)
 {
     QList<LiveRosterItem>::operator=(other);
     d->groupsDelimiter             = other.d->groupsDelimiter;
+    d->version                     = other.d->version;
     return *this;
 }
 void LiveRoster::flagAllForDelete()
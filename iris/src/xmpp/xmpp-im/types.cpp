@@ -2499,6 +2499,7 @@ bool RosterItem::fromXml(const QDomElement &item)
 class Roster::Private {
 public:
     QString groupsDelimiter;
+    QString version;
 };
 
 Roster::Roster() : QList<RosterItem>(), d(new Roster::Private) { }
@@ -2508,12 +2509,14 @@ Roster::~Roster() { delete d; }
 Roster::Roster(const Roster &other) : QList<RosterItem>(other), d(new Roster::Private)
 {
     d->groupsDelimiter = other.d->groupsDelimiter;
+    d->version         = other.d->version;
 }
 
 Roster &Roster::operator=(const Roster &other)
 {
     QList<RosterItem>::operator=(other);
     d->groupsDelimiter         = other.d->groupsDelimiter;
+    d->version                 = other.d->version;
     return *this;
 }
 
@@ -2541,6 +2544,10 @@ void Roster::setGroupsDelimiter(const QString &groupsDelimiter) { d->groupsDelim
 
 QString Roster::groupsDelimiter() const { return d->groupsDelimiter; }
 
+void Roster::setVersion(const QString &version) { d->version = version; }
+
+QString Roster::version() const { return d->version; }
+
 //---------------------------------------------------------------------------
 // FormField
 //---------------------------------------------------------------------------
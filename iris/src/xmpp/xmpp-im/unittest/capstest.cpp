@@ -0,0 +1,191 @@
+/*
+ * capstest.cpp - CapsRegistry persistence tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "qttestutil/qttestutil.h"
+#include "xmpp_caps.h"
+
+#include <QDomDocument>
+#include <QObject>
+#include <QtTest/QtTest>
+
+using namespace XMPP;
+
+// keeps the saved data in memory, the way PsiCapsRegistry keeps it in caps.xml
+class MemoryCapsRegistry : public CapsRegistry {
+public:
+    QByteArray stored;
+    int        saves      = 0;
+    bool       appendable = true;
+
+protected:
+    void saveData(const QByteArray &data) override
+    {
+        stored = data;
+        ++saves;
+    }
+
+    QByteArray loadData() override { return stored; }
+
+    bool appendData(const QByteArray &data) override
+    {
+        if (appendable)
+            stored += data;
+        return appendable;
+    }
+};
+
+class CapsTest : public QObject {
+    Q_OBJECT
+
+private:
+    static QString node(const QString &ver) { return "https://psi-plus.com#" + ver; }
+
+    static DiscoItem item(const QString &feature)
+    {
+        DiscoItem item;
+        item.setIdentities(DiscoItem::Identity("client", "pc", QString(), "Psi"));
+        item.setFeatures(Features(QStringList { "http://jabber.org/protocol/disco#info", feature }));
+        return item;
+    }
+
+    static CapsSpec spec(const QString &ver) { return CapsSpec("https://psi-plus.com", QCryptographicHash::Sha1, ver); }
+
+    // a record the way registerCaps() appends it
+    static QByteArray infoRecord(const QString &ver, const QDateTime &lastSeen)
+    {
+        QDomDocument doc;
+        QDomElement  info = CapsInfo(item("urn:xmpp:ping"), lastSeen).toXml(&doc);
+        info.setAttribute("node", node(ver));
+        doc.appendChild(info);
+        return doc.toString().toUtf8();
+    }
+
+    static QByteArray seenRecord(const QString &ver, const QDateTime &when)
+    {
+        return QString("<seen node=\"%1\">%2</seen>\n").arg(node(ver), when.toString(Qt::ISODate)).toUtf8();
+    }
+
+    // reloading a compacted save must not need another one
+    static void verifyCompacted(const QByteArray &data, const QStringList &vers)
+    {
+        QVERIFY(data.trimmed().startsWith("<capabilities"));
+        MemoryCapsRegistry reg;
+        reg.stored = data;
+        reg.load();
+        QCOMPARE(reg.saves, 0);
+        for (const auto &ver : vers)
+            QVERIFY2(reg.isRegistered(node(ver)), qPrintable(ver));
+    }
+
+private slots:
+    void testMigrateFullDocument()
+    {
+        // caps.xml as written before records were appended to it
+        QDateTime  recent = QDateTime::currentDateTime().addDays(-1);
+        QByteArray data   = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<capabilities>\n" + infoRecord("a", recent)
+            + infoRecord("b", recent) + "</capabilities>\n";
+
+        MemoryCapsRegistry reg;
+        reg.stored = data;
+        reg.load();
+        QVERIFY(reg.isRegistered(node("a")));
+        QVERIFY(reg.isRegistered(node("b")));
+        QVERIFY(reg.features(node("a")).list().contains("urn:xmpp:ping"));
+        QCOMPARE(reg.saves, 0); // nothing to fold in or drop
+        QCOMPARE(reg.stored, data);
+    }
+
+    void testExpiry()
+    {
+        QDateTime  old  = QDateTime::currentDateTime().addMonths(-4);
+        QDateTime  now  = QDateTime::currentDateTime();
+        QByteArray data = "<capabilities>\n" + infoRecord("old", old) + infoRecord("kept", old)
+            + infoRecord("new", now) + "</capabilities>\n" + seenRecord("kept", now);
+
+        MemoryCapsRegistry reg;
+        reg.stored = data;
+        reg.load();
+        QVERIFY(!reg.isRegistered(node("old")));
+        QVERIFY(reg.isRegistered(node("kept"))); // seen again since the last full save
+        QVERIFY(reg.isRegistered(node("new")));
+        QCOMPARE(reg.saves, 1);
+        verifyCompacted(reg.stored, { "kept", "new" });
+    }
+
+    void testAppendedRecords()
+    {
+        MemoryCapsRegistry writer;
+        writer.registerCaps(spec("a"), item("urn:xmpp:ping"));
+        writer.save();
+        writer.registerCaps(spec("b"), item("urn:xmpp:time"));
+        writer.registerCaps(spec("c"), item("urn:xmpp:receipts"));
+        QCOMPARE(writer.saves, 1); // only the explicit one
+        QVERIFY(writer.stored.contains("urn:xmpp:receipts"));
+
+        MemoryCapsRegistry reg;
+        reg.stored = writer.stored;
+        reg.load();
+        QVERIFY(reg.isRegistered(node("a")));
+        QVERIFY(reg.isRegistered(node("b")));
+        QVERIFY(reg.features(node("c")).list().contains("urn:xmpp:receipts"));
+        QCOMPARE(reg.saves, 1);
+        verifyCompacted(reg.stored, { "a", "b", "c" });
+    }
+
+    void testWithoutAppend()
+    {
+        MemoryCapsRegistry writer;
+        writer.appendable = false;
+        writer.registerCaps(spec("a"), item("urn:xmpp:ping"));
+        QCOMPARE(writer.saves, 1);
+        verifyCompacted(writer.stored, { "a" });
+    }
+
+    void testBrokenTail()
+    {
+        MemoryCapsRegistry writer;
+        writer.registerCaps(spec("a"), item("urn:xmpp:ping"));
+        writer.save();
+        writer.registerCaps(spec("b"), item("urn:xmpp:time"));
+        QByteArray cut = infoRecord("c", QDateTime::currentDateTime());
+        writer.stored += cut.left(cut.size() / 2); // the write of the last record didn't make it
+
+        MemoryCapsRegistry reg;
+        reg.stored = writer.stored;
+        reg.load();
+        QVERIFY(reg.isRegistered(node("a")));
+        QVERIFY(reg.isRegistered(node("b")));
+        QVERIFY(!reg.isRegistered(node("c")));
+        QCOMPARE(reg.saves, 1);
+        verifyCompacted(reg.stored, { "a", "b" });
+    }
+
+    void testBrokenBase()
+    {
+        QByteArray base = "<capabilities>\n" + infoRecord("a", QDateTime::currentDateTime()) + "</capabilities>\n";
+
+        MemoryCapsRegistry reg;
+        reg.stored = base.left(base.size() / 2);
+        reg.load();
+        QVERIFY(!reg.isRegistered(node("a")));
+        QCOMPARE(reg.saves, 0);
+    }
+};
+
+QTTESTUTIL_REGISTER_TEST(CapsTest);
+#include "capstest.moc"
@@ -0,0 +1,98 @@
+/*
+ * ibbtest.cpp - Inband bytestream tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "qttestutil/qttestutil.h"
+#include "xmpp_client.h"
+#include "xmpp_ibb.h"
+
+#include <QDomDocument>
+#include <QObject>
+#include <QPointer>
+#include <QtTest/QtTest>
+
+using namespace XMPP;
+
+class IBBTest : public QObject {
+    Q_OBJECT
+
+private:
+    static QDomElement openRequest(QDomDocument &doc, const QString &from, const QString &sid)
+    {
+        QDomElement iq = doc.createElement("iq");
+        iq.setAttribute("type", "set");
+        iq.setAttribute("from", from);
+        iq.setAttribute("id", "open1");
+        QDomElement open = doc.createElementNS("http://jabber.org/protocol/ibb", "open");
+        open.setAttribute("sid", sid);
+        open.setAttribute("block-size", 16);
+        iq.appendChild(open);
+        return iq;
+    }
+
+    static QList<JT_IBB *> pendingTasks(Client &client)
+    {
+        QList<JT_IBB *> tasks;
+        const auto      children = client.rootTask()->children();
+        for (QObject *o : children) {
+            JT_IBB *j = qobject_cast<JT_IBB *>(o);
+            if (j)
+                tasks.append(j);
+        }
+        return tasks;
+    }
+
+private slots:
+    void testDeleteWithPacketsInFlight()
+    {
+        Client       client;
+        IBBManager * m = client.ibbManager();
+        QDomDocument doc;
+        Jid          peer("peer@example.com/res");
+
+        QVERIFY(client.rootTask()->take(openRequest(doc, peer.full(), "s1")));
+        IBBConnection *c = m->takeIncoming();
+        QVERIFY(c);
+        c->accept();
+        QCOMPARE(c->state(), int(IBBConnection::Active));
+        QVERIFY(!m->isAcceptableSID(peer, "s1"));
+
+        // more blocks than the send window, so some are in flight and some are still buffered
+        int before = pendingTasks(client).size();
+        c->write(QByteArray(16 * 6, 'x'));
+        QList<QPointer<JT_IBB>> sending;
+        for (JT_IBB *j : pendingTasks(client))
+            sending.append(j);
+        QVERIFY(sending.size() > before);
+        QVERIFY(c->bytesToWrite() > 0);
+
+        delete c;
+
+        // the connection must not be reachable from the manager anymore
+        QVERIFY(m->isAcceptableSID(peer, "s1"));
+
+        // data packets are gone and only the <close/> request replaced them
+        int alive = 0;
+        for (const auto &j : sending)
+            alive += j ? 1 : 0;
+        QCOMPARE(alive, before);
+        QCOMPARE(pendingTasks(client).size(), before + 1);
+    }
+};
+
+QTTESTUTIL_REGISTER_TEST(IBBTest);
+#include "ibbtest.moc"
@@ -0,0 +1,3 @@
+SOURCES += \
+    $$PWD/capstest.cpp \
+    $$PWD/ibbtest.cpp
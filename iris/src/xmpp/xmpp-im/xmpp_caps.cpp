@@ -36,6 +36,7 @@
 #include <QDomElement>
 #include <QFile>
 #include <QTextCodec>
+#include <QXmlStreamReader>
 
 namespace XMPP {
 QDomElement CapsInfo::toXml(QDomDocument *doc) const
@@ -48,7 +49,7 @@ QDomElement CapsInfo::toXml(QDomDocument *doc) const
 
 CapsInfo CapsInfo::fromXml(const QDomElement &caps)
 {
-    QDateTime lastSeen = QDateTime::fromString(caps.firstChildElement("atime").nodeValue(), Qt::ISODate);
+    QDateTime lastSeen = QDateTime::fromString(caps.firstChildElement("atime").text(), Qt::ISODate);
     DiscoItem item     = DiscoItem::fromDiscoInfoResult(caps.firstChildElement("query"));
     if (item.features().isEmpty()) { // it's hardly possible if client does not support anything.
         return CapsInfo();
@@ -79,8 +80,18 @@ CapsRegistry *CapsRegistry::instance()
 
 void CapsRegistry::setInstance(CapsRegistry *instance) { instance_ = instance; }
 
+// keep unseen info for last 3 month. adjust if required
+#define CAPS_KEEP_MONTHS 3
+
+// don't record a caps node being seen again more often than this
+#define CAPS_SEEN_RESOLUTION (24 * 60 * 60) /* secs */
+
 /**
  * \brief Convert all capabilities info to XML.
+ *
+ * This writes the whole registry in one go. While running, new entries are
+ * appended to the saved data instead (if the subclass supports it), and
+ * load() folds them back in with a full save.
  */
 void CapsRegistry::save()
 {
@@ -106,6 +117,36 @@ void CapsRegistry::saveData(const QByteArray &data)
 
 QByteArray CapsRegistry::loadData() { return QByteArray(); }
 
+bool CapsRegistry::appendData(const QByteArray &data)
+{
+    Q_UNUSED(data)
+    return false;
+}
+
+// The saved data is the <capabilities/> document written by save(), followed by the <info/> and <seen/> records
+// appended since. Returns the offsets just past each of these top-level elements, up to the first one that is
+// incomplete or malformed, i.e. a write cut short.
+static QList<int> elementEnds(const QString &data)
+{
+    QList<int>       ends;
+    QXmlStreamReader reader(data);
+    int              offset = 0; // of the reader's data in data
+    int              depth  = 0;
+    while (!reader.atEnd()) {
+        auto token = reader.readNext();
+        if (token == QXmlStreamReader::StartElement)
+            ++depth;
+        else if (token == QXmlStreamReader::EndElement && --depth == 0) {
+            offset += int(reader.characterOffset());
+            ends.append(offset);
+            // a document has only one root element, so the next one gets a fresh start
+            reader.clear();
+            reader.addData(data.mid(offset));
+        }
+    }
+    return ends;
+}
+
 /**
  * \brief Sets the file to save the capabilities info to
  */
@@ -116,45 +157,85 @@ void CapsRegistry::load()
         return;
     }
 
-    // Load settings
-    QDomDocument doc;
-
-    if (!doc.setContent(QString::fromUtf8(data))) {
+    QString    text = QString::fromUtf8(data);
+    QList<int> ends = elementEnds(text);
+    if (ends.isEmpty()) {
         qWarning() << "CapsRegistry: Cannnot parse input";
         return;
     }
 
-    QDomElement caps = doc.documentElement();
-    if (caps.tagName() != "capabilities") {
-        qWarning("caps.cpp: Invalid capabilities element");
-        return;
-    }
-
-    // keep unseen info for last 3 month. adjust if required
-    QDateTime validTime = QDateTime::currentDateTime().addMonths(-3);
-    for (QDomNode n = caps.firstChild(); !n.isNull(); n = n.nextSibling()) {
-        QDomElement i = n.toElement();
-        if (i.isNull()) {
-            qWarning("capsregistry.cpp: Null element");
+    QDateTime validTime = QDateTime::currentDateTime().addMonths(-CAPS_KEEP_MONTHS);
+    bool      compact   = false; // something to fold into a fresh save or to drop from it
+    auto      readInfo  = [this, &compact](const QDomElement &i) {
+        QString node = i.attribute("node");
+        int     sep  = node.indexOf('#');
+        if (sep > 0 && sep + 1 < node.length()) {
+            CapsInfo info = CapsInfo::fromXml(i);
+            if (info.isValid()) {
+                capsInfo_[node] = info; // a later <seen/> may still save it from expiring
+            } else
+                compact = true;
+            // qDebug() << QString("Read %1 %2").arg(node).arg(ver);
+        } else {
+            qWarning() << "capsregistry.cpp: Node" << node << "invalid";
+        }
+    };
+
+    // each element is parsed on its own, so one bad record costs only itself
+    int start = 0;
+    for (int end : qAsConst(ends)) {
+        QDomDocument doc;
+        bool         parsed = doc.setContent(text.mid(start, end - start));
+        start               = end;
+        if (!parsed) {
+            qWarning("capsregistry.cpp: Skipping unparsable element");
+            compact = true;
             continue;
         }
 
-        if (i.tagName() == "info") {
-            QString node = i.attribute("node");
-            int     sep  = node.indexOf('#');
-            if (sep > 0 && sep + 1 < node.length()) {
-                CapsInfo info = CapsInfo::fromXml(i);
-                if (info.isValid() && info.lastSeen() > validTime) {
-                    capsInfo_[node] = CapsInfo::fromXml(i);
+        QDomElement e = doc.documentElement();
+        if (e.tagName() == "capabilities") {
+            for (QDomNode n = e.firstChild(); !n.isNull(); n = n.nextSibling()) {
+                QDomElement i = n.toElement();
+                if (i.isNull()) {
+                    qWarning("capsregistry.cpp: Null element");
+                    continue;
                 }
-                // qDebug() << QString("Read %1 %2").arg(node).arg(ver);
-            } else {
-                qWarning() << "capsregistry.cpp: Node" << node << "invalid";
+                if (i.tagName() == "info")
+                    readInfo(i);
+                else
+                    qWarning("capsregistry.cpp: Unknown element");
             }
+        } else if (e.tagName() == "info") {
+            readInfo(e);
+            compact = true;
+        } else if (e.tagName() == "seen") {
+            auto it = capsInfo_.find(e.attribute("node"));
+            if (it != capsInfo_.end())
+                it.value().setLastSeen(QDateTime::fromString(e.text(), Qt::ISODate));
+            compact = true;
         } else {
             qWarning("capsregistry.cpp: Unknown element");
         }
     }
+
+    for (auto it = capsInfo_.begin(); it != capsInfo_.end();) {
+        if (it.value().lastSeen() > validTime)
+            ++it;
+        else {
+            it      = capsInfo_.erase(it);
+            compact = true;
+        }
+    }
+
+    // whatever follows the last good element is dropped by the compacting save
+    if (!text.midRef(start).trimmed().isEmpty()) {
+        qWarning("capsregistry.cpp: Dropping a broken record at the end");
+        compact = true;
+    }
+
+    if (compact)
+        save();
 }
 
 /**
@@ -166,10 +247,42 @@ void CapsRegistry::registerCaps(const CapsSpec &spec, const DiscoItem &item)
     if (!isRegistered(dnode)) {
         CapsInfo info(item);
         capsInfo_[dnode] = info;
+
+        QDomDocument doc;
+        QDomElement  record = info.toXml(&doc);
+        record.setAttribute("node", dnode);
+        doc.appendChild(record);
+        if (!appendData(doc.toString().toUtf8()))
+            save();
+
         emit registered(spec);
     }
 }
 
+/**
+ * \brief Notes that a client with these caps showed up, to keep them from expiring.
+ */
+void CapsRegistry::markSeen(const QString &spec)
+{
+    auto it = capsInfo_.find(spec);
+    if (it == capsInfo_.end())
+        return;
+
+    QDateTime now = QDateTime::currentDateTime();
+    if (it.value().lastSeen().secsTo(now) < CAPS_SEEN_RESOLUTION)
+        return;
+
+    it.value().setLastSeen(now);
+
+    // this one isn't worth a full save. without appending it's simply
+    // recorded with the next one
+    QDomDocument doc;
+    QDomElement  record = textTag(&doc, "seen", now.toString(Qt::ISODate));
+    record.setAttribute("node", spec);
+    doc.appendChild(record);
+    appendData(doc.toString().toUtf8());
+}
+
 /**
  * \brief Checks if capabilities have been registered.
  */
@@ -177,8 +290,18 @@ bool CapsRegistry::isRegistered(const QString &spec) const { return capsInfo_.co
 
 DiscoItem CapsRegistry::disco(const QString &spec) const
 {
-    CapsInfo ci = capsInfo_.value(spec);
-    return ci.disco();
+    auto it = capsInfo_.constFind(spec);
+    return it == capsInfo_.constEnd() ? DiscoItem() : it.value().disco();
+}
+
+/**
+ * \brief Returns features of registered caps node.
+ * Feature bits are computed once when the caps are registered, so it's cheap to test the result.
+ */
+Features CapsRegistry::features(const QString &spec) const
+{
+    auto it = capsInfo_.constFind(spec);
+    return it == capsInfo_.constEnd() ? Features() : it.value().disco().features();
 }
 
 /*--------------------------------------------------------------
@@ -232,25 +355,32 @@ void CapsManager::updateCaps(const Jid &jid, const CapsSpec &c)
         return;
 
     QString fullNode = c.flatten();
-    if (capsSpecs_[jid.full()] != c) {
+    QString fullJid  = jid.full();
+    auto    oldSpec  = capsSpecs_.constFind(fullJid);
+    if (oldSpec == capsSpecs_.constEnd() || oldSpec.value() != c) {
         // qDebug() << QString("caps.cpp: Updating caps for %1
         // (node=%2,ver=%3,ext=%4)").arg(QString(jid.full()).replace('%',"%%")).arg(node).arg(ver).arg(ext);
 
         // Unregister from all old caps node
-        capsJids_[capsSpecs_[jid.full()].flatten()].removeAll(jid.full());
+        if (oldSpec != capsSpecs_.constEnd()) {
+            unregisterJid(oldSpec.value().flatten(), fullJid);
+        }
 
         if (c.isValid()) {
             // Register with all new caps nodes
-            capsSpecs_[jid.full()] = c;
-            if (!capsJids_[fullNode].contains(jid.full())) {
-                capsJids_[fullNode].push_back(jid.full());
-            }
+            capsSpecs_[fullJid] = c;
+            auto &jids          = capsJids_[fullNode];
+            jids.insert(fullJid);
+            // slots below may update caps and rehash capsJids_
+            const bool firstJid = jids.count() == 1;
 
             emit capsChanged(jid);
 
+            CapsRegistry::instance()->markSeen(fullNode);
+
             // Register new caps and check if we need to discover features
             if (isEnabled()) {
-                if (!CapsRegistry::instance()->isRegistered(fullNode) && capsJids_[fullNode].count() == 1) {
+                if (!CapsRegistry::instance()->isRegistered(fullNode) && firstJid) {
                     // qDebug() << QString("caps.cpp: Sending disco request to %1,
                     // node=%2").arg(QString(jid.full()).replace('%',"%%")).arg(node + "#" + s.extensions());
                     JT_DiscoInfo *disco = new JT_DiscoInfo(client_->rootTask());
@@ -264,11 +394,21 @@ void CapsManager::updateCaps(const Jid &jid, const CapsSpec &c)
             // Remove all caps specifications
             qWarning() << QString("caps.cpp: Illegal caps info from %1: node=%2, ver=%3")
                               .arg(QString(jid.full()).replace('%', "%%"), fullNode, c.version());
-            capsSpecs_.remove(jid.full());
+            capsSpecs_.remove(fullJid);
         }
     } else {
         // Add to the list of jids
-        capsJids_[fullNode].push_back(jid.full());
+        capsJids_[fullNode].insert(fullJid);
+    }
+}
+
+void CapsManager::unregisterJid(const QString &node, const QString &fullJid)
+{
+    auto it = capsJids_.find(node);
+    if (it != capsJids_.end()) {
+        it.value().remove(fullJid);
+        if (it.value().isEmpty())
+            capsJids_.erase(it);
     }
 }
 
@@ -280,12 +420,11 @@ void CapsManager::updateCaps(const Jid &jid, const CapsSpec &c)
 void CapsManager::disableCaps(const Jid &jid)
 {
     // qDebug() << QString("caps.cpp: Disabling caps for %1.").arg(QString(jid.full()).replace('%',"%%"));
-    if (capsEnabled(jid)) {
-        QString node = capsSpecs_[jid.full()].flatten();
-        if (!node.isEmpty()) {
-            capsJids_[node].removeAll(jid.full());
-        }
-        capsSpecs_.remove(jid.full());
+    QString fullJid = jid.full();
+    auto    it      = capsSpecs_.find(fullJid);
+    if (it != capsSpecs_.end()) {
+        unregisterJid(it.value().flatten(), fullJid);
+        capsSpecs_.erase(it);
         emit capsChanged(jid);
     }
 }
@@ -319,8 +458,9 @@ void CapsManager::updateDisco(const Jid &jid, const DiscoItem &item)
  */
 void CapsManager::capsRegistered(const CapsSpec &cs)
 {
-    // Notify affected jids.
-    for (const QString &s : qAsConst(capsJids_[cs.flatten()])) {
+    // Notify affected jids. Copy since receivers may update caps
+    const auto jids = capsJids_.value(cs.flatten());
+    for (const QString &s : jids) {
         // qDebug() << QString("caps.cpp: Notifying %1.").arg(s.replace('%',"%%"));
         emit capsChanged(s);
     }
@@ -337,19 +477,25 @@ bool CapsManager::capsEnabled(const Jid &jid) const { return capsSpecs_.contains
 XMPP::DiscoItem CapsManager::disco(const Jid &jid) const
 {
     // qDebug() << "caps.cpp: Retrieving features of " << jid.full();
-    QStringList f;
-    if (!capsEnabled(jid)) {
+    auto it = capsSpecs_.constFind(jid.full());
+    if (it == capsSpecs_.constEnd()) {
         return DiscoItem();
     }
-    QString node = capsSpecs_[jid.full()].flatten();
     // qDebug() << QString("    %1").arg(CapsRegistry::instance()->features(s).list().join("\n"));
-    return CapsRegistry::instance()->disco(node);
+    return CapsRegistry::instance()->disco(it.value().flatten());
 }
 
 /**
  * \brief Requests the list of features of a given JID.
  */
-XMPP::Features CapsManager::features(const Jid &jid) const { return disco(jid).features(); }
+XMPP::Features CapsManager::features(const Jid &jid) const
+{
+    auto it = capsSpecs_.constFind(jid.full());
+    if (it == capsSpecs_.constEnd()) {
+        return Features();
+    }
+    return CapsRegistry::instance()->features(it.value().flatten());
+}
 
 /**
  * \brief Returns the client name of a given jid.
@@ -23,7 +23,9 @@
 #include "xmpp_features.h"
 #include "xmpp_status.h"
 
+#include <QHash>
 #include <QPointer>
+#include <QSet>
 
 namespace XMPP {
 class CapsInfo {
@@ -35,6 +37,7 @@ public:
     }
     inline bool                   isValid() const { return _lastSeen.isValid(); }
     inline const QDateTime &      lastSeen() const { return _lastSeen; }
+    inline void                   setLastSeen(const QDateTime &lastSeen) { _lastSeen = lastSeen; }
     inline const XMPP::DiscoItem &disco() const { return _disco; }
     QDomElement                   toXml(QDomDocument *doc) const;
     static CapsInfo               fromXml(const QDomElement &ci);
@@ -54,8 +57,10 @@ public:
     static void          setInstance(CapsRegistry *instance);
 
     void      registerCaps(const CapsSpec &, const XMPP::DiscoItem &item);
+    void      markSeen(const QString &);
     bool      isRegistered(const QString &) const;
     DiscoItem disco(const QString &) const;
+    Features  features(const QString &) const;
 
 signals:
     void registered(const XMPP::CapsSpec &);
@@ -65,8 +70,9 @@ public slots:
     void save();
 
 protected:
-    virtual void       saveData(const QByteArray &data); // reimplmenet these two functions
-    virtual QByteArray loadData();                       // to have permanent cache
+    virtual void       saveData(const QByteArray &data);   // reimplmenet these two functions
+    virtual QByteArray loadData();                         // to have permanent cache
+    virtual bool       appendData(const QByteArray &data); // optional. returns false if not supported
 
 private:
     static CapsRegistry *    instance_;
@@ -107,10 +113,12 @@ protected slots:
     void capsRegistered(const CapsSpec &);
 
 private:
+    void unregisterJid(const QString &node, const QString &fullJid);
+
     Client *                      client_;
     bool                          isEnabled_;
-    QMap<QString, CapsSpec>       capsSpecs_;
-    QMap<QString, QList<QString>> capsJids_;
+    QHash<QString, CapsSpec>      capsSpecs_; // full jid -> caps
+    QHash<QString, QSet<QString>> capsJids_;  // caps node -> full jids
 };
 } // namespace XMPP
 
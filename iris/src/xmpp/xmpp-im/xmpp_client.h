@@ -105,6 +105,12 @@ public:
     void                   setNetworkAccessManager(QNetworkAccessManager *qnam);
     QNetworkAccessManager *networkAccessManager() const;
 
+    void setCachedRoster(const Roster &);
+    bool isRosterVersioningSupported() const;
+    bool isClientStateIndicationSupported() const;
+    void setClientActive(bool active);
+    bool isClientActive() const;
+    void sendClientState();
     void rosterRequest(bool withGroupsDelimiter = true);
     void sendMessage(Message &);
     void sendSubscription(const Jid &, const QString &, const QString &nick = QString());
@@ -189,6 +195,9 @@ signals:
     void debugText(const QString &);
     void xmlIncoming(const QString &);
     void xmlOutgoing(const QString &);
+    // the traced stanzas unserialized, for consumers that format them only when needed
+    void stanzaIncoming(const QDomElement &);
+    void stanzaOutgoing(const QDomElement &);
     void stanzaElementOutgoing(QDomElement &);
     void groupChatJoined(const Jid &);
     void groupChatLeft(const Jid &);
@@ -228,8 +237,14 @@ private slots:
 public:
     class GroupChat;
 
+protected:
+    void connectNotify(const QMetaMethod &signal) override;
+    void disconnectNotify(const QMetaMethod &signal) override;
+
 private:
     void cleanup();
+    void updateXmlTracing();
+    bool isTracing(bool incoming) const;
     void distribute(const QDomElement &);
     void importRoster(const Roster &);
     void importRosterItem(const RosterItem &);
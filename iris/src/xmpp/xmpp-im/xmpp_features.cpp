@@ -23,12 +23,78 @@
 #include "jingle.h"
 
 #include <QCoreApplication>
+#include <QHash>
 #include <QMap>
 #include <QString>
 #include <QStringList>
 
 using namespace XMPP;
 
+// namespaces with a hasXxx() helper
+#define FID_MULTICAST "http://jabber.org/protocol/address"
+#define FID_AHCOMMAND "http://jabber.org/protocol/commands"
+#define FID_REGISTER "jabber:iq:register"
+#define FID_SEARCH "jabber:iq:search"
+#define FID_GROUPCHAT "http://jabber.org/protocol/muc"
+#define FID_VOICE "http://www.google.com/xmpp/protocol/voice/v1"
+#define FID_GATEWAY "jabber:iq:gateway"
+#define FID_QUERYVERSION "jabber:iq:version"
+#define FID_DISCO "http://jabber.org/protocol/disco"
+#define FID_CHATSTATE "http://jabber.org/protocol/chatstates"
+#define FID_VCARD "vcard-temp"
+#define FID_MESSAGECARBONS "urn:xmpp:carbons:2"
+#define FID_JINGLEICEUDP "urn:xmpp:jingle:transports:ice-udp:1"
+#define FID_JINGLEICE "urn:xmpp:jingle:transports:ice:0"
+#define NS_CAPS "http://jabber.org/protocol/caps"
+#define NS_CAPS_OPTIMIZE "http://jabber.org/protocol/caps#optimize"
+#define NS_DIRECT_MUC_INVITE "jabber:x:conference"
+
+namespace {
+/*
+ * Numbers the feature namespaces which have a hasXxx() helper, so that these
+ * helpers are a bit test in Features::_bits. Other namespaces are looked up in
+ * Features::_list. The table never changes once built, so it needs no locking.
+ */
+class KnownFeatures {
+public:
+    KnownFeatures()
+    {
+        const QString known[] = {
+            QLatin1String(FID_DISCO),
+            QLatin1String("http://jabber.org/protocol/disco#info"),
+            QLatin1String("http://jabber.org/protocol/disco#items"),
+            Jingle::FileTransfer::NS,
+            QLatin1String(FID_MULTICAST),
+            QLatin1String(FID_AHCOMMAND),
+            QLatin1String(FID_REGISTER),
+            QLatin1String(FID_SEARCH),
+            QLatin1String(FID_GROUPCHAT),
+            QLatin1String(FID_VOICE),
+            QLatin1String(FID_GATEWAY),
+            QLatin1String(FID_QUERYVERSION),
+            QLatin1String(FID_CHATSTATE),
+            QLatin1String(FID_VCARD),
+            QLatin1String(FID_MESSAGECARBONS),
+            QLatin1String(FID_JINGLEICEUDP),
+            QLatin1String(FID_JINGLEICE),
+            QLatin1String(NS_CAPS),
+            QLatin1String(NS_CAPS_OPTIMIZE),
+            QLatin1String(NS_DIRECT_MUC_INVITE)
+        };
+        for (const QString &ns : known)
+            ids_.insert(ns, ids_.size());
+    }
+
+    // returns -1 for namespaces without a helper
+    int find(const QString &ns) const { return ids_.value(ns, -1); }
+
+private:
+    QHash<QString, int> ids_;
+};
+
+Q_GLOBAL_STATIC(KnownFeatures, knownFeatures)
+} // namespace
+
 Features::Features() { }
 
 Features::Features(const QStringList &l) { setList(l); }
@@ -45,6 +111,20 @@ Features::Features(const QString &str)
 
 Features::~Features() { }
 
+void Features::setBit(const QString &ns)
+{
+    int id = knownFeatures->find(ns);
+    if (id < 0)
+        return;
+    if (id >= _bits.size())
+        _bits.resize(id + 1);
+    _bits.setBit(id);
+}
+
+bool Features::testBit(int id) const { return id >= 0 && id < _bits.size() && _bits.testBit(id); }
+
+int Features::knownId(const QString &ns) { return knownFeatures->find(ns); }
+
 QStringList Features::list() const
 {
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
@@ -57,162 +137,165 @@ QStringList Features::list() const
 void Features::setList(const QStringList &l)
 {
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-    _list = QSet<QString>(l.begin(), l.end());
+    setList(QSet<QString>(l.begin(), l.end()));
 #else
-    _list   = QSet<QString>::fromList(l);
+    setList(QSet<QString>::fromList(l));
 #endif
 }
 
-void Features::setList(const QSet<QString> &l) { _list = l; }
+void Features::setList(const QSet<QString> &l)
+{
+    _list = l;
+    _bits.clear();
+    for (const QString &ns : l) {
+        setBit(ns);
+    }
+}
 
-void Features::addFeature(const QString &s) { _list += s; }
+void Features::addFeature(const QString &s)
+{
+    _list += s;
+    setBit(s);
+}
 
 bool Features::test(const QStringList &ns) const
 {
-#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-    auto ss = QSet<QString>(ns.begin(), ns.end());
-#else
-    auto ss = QSet<QString>::fromList(ns);
-#endif
-    return _list.contains(ss);
+    for (const QString &s : ns) {
+        if (!test(s))
+            return false;
+    }
+    return true;
 }
 
-bool Features::test(const QSet<QString> &ns) const { return _list.contains(ns); }
+bool Features::test(const QSet<QString> &ns) const
+{
+    for (const QString &s : ns) {
+        if (!test(s))
+            return false;
+    }
+    return true;
+}
 
 bool Features::test(const QString &ns) const { return _list.contains(ns); }
 
-#define FID_MULTICAST "http://jabber.org/protocol/address"
-bool Features::hasMulticast() const
+Features &Features::operator+=(const Features &other)
 {
-    QSet<QString> ns;
-    ns << FID_MULTICAST;
+    _list += other._list;
+    if (other._bits.size() > _bits.size())
+        _bits.resize(other._bits.size());
+    _bits |= other._bits;
+    return *this;
+}
 
-    return test(ns);
+bool Features::hasMulticast() const
+{
+    static const int id = knownId(QLatin1String(FID_MULTICAST));
+    return testBit(id);
 }
 
-#define FID_AHCOMMAND "http://jabber.org/protocol/commands"
 bool Features::hasCommand() const
 {
-    QSet<QString> ns;
-    ns << FID_AHCOMMAND;
-
-    return test(ns);
+    static const int id = knownId(QLatin1String(FID_AHCOMMAND));
+    return testBit(id);
 }
 
-#define FID_REGISTER "jabber:iq:register"
 bool Features::hasRegister() const
 {
-    QSet<QString> ns;
-    ns << FID_REGISTER;
-
-    return test(ns);
+    static const int id = knownId(QLatin1String(FID_REGISTER));
+    return testBit(id);
 }
 
-#define FID_SEARCH "jabber:iq:search"
 bool Features::hasSearch() const
 {
-    QSet<QString> ns;
-    ns << FID_SEARCH;
-
-    return test(ns);
+    static const int id = knownId(QLatin1String(FID_SEARCH));
+    return testBit(id);
 }
 
-#define FID_GROUPCHAT "http://jabber.org/protocol/muc"
 bool Features::hasGroupchat() const
 {
-    QSet<QString> ns;
-    ns << FID_GROUPCHAT;
-
-    return test(ns);
+    static const int id = knownId(QLatin1String(FID_GROUPCHAT));
+    return testBit(id);
 }
 
-#define FID_VOICE "http://www.google.com/xmpp/protocol/voice/v1"
 bool Features::hasVoice() const
 {
-    QSet<QString> ns;
-    ns << FID_VOICE;
-
-    return test(ns);
+    static const int id = knownId(QLatin1String(FID_VOICE));
+    return testBit(id);
 }
 
-#define FID_GATEWAY "jabber:iq:gateway"
 bool Features::hasGateway() const
 {
-    QSet<QString> ns;
-    ns << FID_GATEWAY;
-
-    return test(ns);
+    static const int id = knownId(QLatin1String(FID_GATEWAY));
+    return testBit(id);
 }
 
-#define FID_QUERYVERSION "jabber:iq:version"
 bool Features::hasVersion() const
 {
-    QSet<QString> ns;
-    ns << FID_QUERYVERSION;
-
-    return test(ns);
+    static const int id = knownId(QLatin1String(FID_QUERYVERSION));
+    return testBit(id);
 }
 
-#define FID_DISCO "http://jabber.org/protocol/disco"
 bool Features::hasDisco() const
 {
-    QSet<QString> ns;
-    ns << FID_DISCO;
-    ns << "http://jabber.org/protocol/disco#info";
-    ns << "http://jabber.org/protocol/disco#items";
-
-    return test(ns);
+    static const int ids[] = { knownId(QLatin1String(FID_DISCO)),
+                               knownId(QLatin1String("http://jabber.org/protocol/disco#info")),
+                               knownId(QLatin1String("http://jabber.org/protocol/disco#items")) };
+    return testBit(ids[0]) && testBit(ids[1]) && testBit(ids[2]);
 }
 
-#define FID_CHATSTATE "http://jabber.org/protocol/chatstates"
 bool Features::hasChatState() const
 {
-    QSet<QString> ns;
-    ns << FID_CHATSTATE;
-
-    return test(ns);
+    static const int id = knownId(QLatin1String(FID_CHATSTATE));
+    return testBit(id);
 }
 
-#define FID_VCARD "vcard-temp"
 bool Features::hasVCard() const
 {
-    QSet<QString> ns;
-    ns << FID_VCARD;
-
-    return test(ns);
+    static const int id = knownId(QLatin1String(FID_VCARD));
+    return testBit(id);
 }
 
-#define FID_MESSAGECARBONS "urn:xmpp:carbons:2"
 bool Features::hasMessageCarbons() const
 {
-    QStringList ns;
-    ns << FID_MESSAGECARBONS;
-
-    return test(ns);
+    static const int id = knownId(QLatin1String(FID_MESSAGECARBONS));
+    return testBit(id);
 }
 
 bool Features::hasJingleFT() const
 {
-    QStringList ns;
-    ns << Jingle::FileTransfer::NS;
-
-    return test(ns);
+    static const int id = knownId(Jingle::FileTransfer::NS);
+    return testBit(id);
 }
 
-#define FID_JINGLEICEUDP "urn:xmpp:jingle:transports:ice-udp:1"
-bool Features::hasJingleIceUdp() const { return test(QStringList() << QLatin1String(FID_JINGLEICEUDP)); }
+bool Features::hasJingleIceUdp() const
+{
+    static const int id = knownId(QLatin1String(FID_JINGLEICEUDP));
+    return testBit(id);
+}
 
-#define FID_JINGLEICE "urn:xmpp:jingle:transports:ice:0"
-bool Features::hasJingleIce() const { return test(QStringList() << QLatin1String(FID_JINGLEICE)); }
+bool Features::hasJingleIce() const
+{
+    static const int id = knownId(QLatin1String(FID_JINGLEICE));
+    return testBit(id);
+}
 
-#define NS_CAPS "http://jabber.org/protocol/caps"
-bool Features::hasCaps() const { return test(QStringList() << QLatin1String(NS_CAPS)); }
+bool Features::hasCaps() const
+{
+    static const int id = knownId(QLatin1String(NS_CAPS));
+    return testBit(id);
+}
 
-#define NS_CAPS_OPTIMIZE "http://jabber.org/protocol/caps#optimize"
-bool Features::hasCapsOptimize() const { return test(QStringList() << QLatin1String(NS_CAPS_OPTIMIZE)); }
+bool Features::hasCapsOptimize() const
+{
+    static const int id = knownId(QLatin1String(NS_CAPS_OPTIMIZE));
+    return testBit(id);
+}
 
-#define NS_DIRECT_MUC_INVITE "jabber:x:conference"
-bool Features::hasDirectMucInvite() const { return test(QStringList() << QLatin1String(NS_DIRECT_MUC_INVITE)); }
+bool Features::hasDirectMucInvite() const
+{
+    static const int id = knownId(QLatin1String(NS_DIRECT_MUC_INVITE));
+    return testBit(id);
+}
 
 // custom Psi actions
 #define FID_ADD "psi:add"
@@ -306,7 +389,7 @@ QString Features::feature(long id)
 
 Features &Features::operator<<(const QString &feature)
 {
-    _list << feature;
+    addFeature(feature);
     return *this;
 }
 
@@ -20,6 +20,7 @@
 #ifndef XMPP_FEATURES_H
 #define XMPP_FEATURES_H
 
+#include <QBitArray>
 #include <QSet>
 #include <QStringList>
 
@@ -105,16 +106,17 @@ public:
 
     Features &  operator<<(const QString &feature);
     inline bool operator==(const Features &other) { return _list == other._list; }
-    Features &  operator+=(const Features &other)
-    {
-        _list += other._list;
-        return *this;
-    }
+    Features &  operator+=(const Features &other);
 
     class FeatureName;
 
 private:
+    void       setBit(const QString &ns);
+    bool       testBit(int id) const;
+    static int knownId(const QString &ns);
+
     QSet<QString> _list;
+    QBitArray     _bits; // namespaces with a hasXxx() helper, see KnownFeatures
 };
 } // namespace XMPP
 
@@ -24,10 +24,9 @@
 #include "xmpp_xmlcommon.h"
 
 #include <QtCrypto>
-#include <qtimer.h>
 #include <stdlib.h>
 
-#define IBB_PACKET_DELAY 0
+#define IBB_SEND_WINDOW 4 /* unacked data packets */
 
 using namespace XMPP;
 
@@ -47,12 +46,12 @@ public:
     Jid         peer;
     QString     sid;
     IBBManager *m = nullptr;
-    JT_IBB *    j = nullptr;
+    JT_IBB *    j = nullptr; // open/close request
     QString     iq_id;
     QString     stanza;
 
-    int blockSize = IBBConnection::PacketSize;
-    // QByteArray recvBuf, sendBuf;
+    int             blockSize = IBBConnection::PacketSize;
+    QList<JT_IBB *> sending; // data packets waiting for ack, oldest first
     bool closePending, closing;
 
     int id; // connection id
@@ -83,6 +82,8 @@ void IBBConnection::resetConnection(bool clear)
 
     delete d->j;
     d->j = nullptr;
+    qDeleteAll(d->sending);
+    d->sending.clear();
 
     clearWriteBuffer();
     if (clear)
@@ -93,7 +94,15 @@ void IBBConnection::resetConnection(bool clear)
 IBBConnection::~IBBConnection()
 {
     clearWriteBuffer(); // drop buffer to make closing procedure fast
-    close();
+    if (d->state == Active && !d->closing) {
+        // nobody is left to wait for the acks, so close the stream right away
+        JT_IBB *j = new JT_IBB(d->m->client()->rootTask());
+        j->close(d->peer, d->sid);
+        j->go(true);
+    } else {
+        close();
+    }
+    resetConnection(true); // drops packets in flight and unlinks from the manager
 
     --num_conn;
 #ifdef IBB_DEBUG
@@ -160,8 +169,8 @@ void IBBConnection::close()
         d->closePending = true;
         trySend();
 
-        // if there is data pending to be written, then pend the closing
-        if (bytesToWrite() > 0 || d->closing) {
+        // if there is data pending to be written or acked, then pend the closing
+        if (bytesToWrite() > 0 || !d->sending.isEmpty() || d->closing) {
             return;
         }
     }
@@ -186,7 +195,7 @@ qint64 IBBConnection::writeData(const char *data, qint64 maxSize)
         return 0;
     }
 
-    ByteStream::appendWrite(QByteArray::fromRawData(data, int(maxSize)));
+    ByteStream::appendWrite(QByteArray(data, int(maxSize)));
     trySend();
     return maxSize;
 }
@@ -229,8 +238,11 @@ void IBBConnection::setRemoteClosed()
 
 void IBBConnection::ibb_finished()
 {
-    JT_IBB *j = d->j;
-    d->j      = nullptr;
+    JT_IBB *j = static_cast<JT_IBB *>(sender());
+    if (j == d->j)
+        d->j = nullptr;
+    else
+        d->sending.removeOne(j);
 
     if (j->success()) {
         if (j->mode() == JT_IBB::ModeRequest) {
@@ -249,7 +261,7 @@ void IBBConnection::ibb_finished()
             }
 
             if (bytesToWrite() || d->closePending)
-                QTimer::singleShot(IBB_PACKET_DELAY, this, SLOT(trySend()));
+                trySend();
 
             emit bytesWritten(j->bytesWritten()); // will delete this connection if no bytes left.
         }
@@ -269,33 +281,36 @@ void IBBConnection::ibb_finished()
 
 void IBBConnection::trySend()
 {
-    // if we already have an active task, then don't do anything
+    // if we already have an open/close task, then don't do anything
     if (d->j)
         return;
 
-    QByteArray a = takeWrite(d->blockSize);
-
-    if (a.isEmpty()) {
-        if (!d->closePending)
-            return; // null operation?
-        d->closePending = false;
-        d->closing      = true;
+    // IQs on a stream are delivered in order, so keep a few packets in flight
+    // instead of paying a full round trip for every block
+    while (bytesToWrite() && d->sending.size() < IBB_SEND_WINDOW) {
+        QByteArray a = takeWrite(d->blockSize);
 #ifdef IBB_DEBUG
-        qDebug("IBBConnection[%d]: closing", d->id);
-#endif
-    } else {
-#ifdef IBB_DEBUG
-        qDebug("IBBConnection[%d]: sending [%d] bytes (%d bytes left)", d->id, a.size(), bytesToWrite());
+        qDebug("IBBConnection[%d]: sending [%d] bytes (%d bytes left)", d->id, a.size(), int(bytesToWrite()));
 #endif
+        JT_IBB *j = new JT_IBB(d->m->client()->rootTask());
+        connect(j, SIGNAL(finished()), SLOT(ibb_finished()));
+        j->sendData(d->peer, IBBData(d->sid, d->seq++, a));
+        d->sending.append(j);
+        j->go(true);
     }
 
+    // close only after the last data packet was acked
+    if (bytesToWrite() || !d->sending.isEmpty() || !d->closePending)
+        return;
+
+    d->closePending = false;
+    d->closing      = true;
+#ifdef IBB_DEBUG
+    qDebug("IBBConnection[%d]: closing", d->id);
+#endif
     d->j = new JT_IBB(d->m->client()->rootTask());
     connect(d->j, SIGNAL(finished()), SLOT(ibb_finished()));
-    if (d->closing) {
-        d->j->close(d->peer, d->sid);
-    } else {
-        d->j->sendData(d->peer, IBBData(d->sid, d->seq++, a));
-    }
+    d->j->close(d->peer, d->sid);
     d->j->go(true);
 }
 
@@ -306,7 +321,7 @@ IBBData &IBBData::fromXml(const QDomElement &e)
 {
     sid  = e.attribute("sid");
     seq  = quint16(e.attribute("seq").toInt());
-    data = QByteArray::fromBase64(e.text().toUtf8());
+    data = QByteArray::fromBase64(e.text().toLatin1()); // base64 is pure ASCII
     return *this;
 }
 
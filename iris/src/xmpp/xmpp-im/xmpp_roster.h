@@ -43,6 +43,10 @@ public:
     void    setGroupsDelimiter(const QString &groupsDelimiter);
     QString groupsDelimiter() const;
 
+    // XEP-0237 roster version
+    void    setVersion(const QString &version);
+    QString version() const;
+
 private:
     class Private;
     Private *d = nullptr;
@@ -69,6 +69,8 @@ static QString lineDecode(const QString &str)
 static Roster xmlReadRoster(const QDomElement &q, bool push)
 {
     Roster r;
+    if (q.hasAttribute(QStringLiteral("ver")))
+        r.setVersion(q.attribute(QStringLiteral("ver")));
 
     for (QDomNode n = q.firstChild(); !n.isNull(); n = n.nextSibling()) {
         QDomElement i = n.toElement();
@@ -342,6 +344,7 @@ public:
     Private() = default;
 
     Roster             roster;
+    bool               rosterUnchanged = false;
     QString            groupsDelimiter;
     QList<QDomElement> itemList;
 };
@@ -354,12 +357,18 @@ JT_Roster::JT_Roster(Task *parent) : Task(parent)
 
 JT_Roster::~JT_Roster() { delete d; }
 
-void JT_Roster::get()
+/**
+ * \brief Requests the roster
+ * \param version XEP-0237 version of the cached roster. Null string if the server doesn't support versioning
+ */
+void JT_Roster::get(const QString &version)
 {
     type = Get;
     // to = client()->host();
     iq                = createIQ(doc(), "get", to.full(), id());
     QDomElement query = doc()->createElementNS("jabber:iq:roster", "query");
+    if (!version.isNull())
+        query.setAttribute("ver", version);
     iq.appendChild(query);
 }
 
@@ -442,6 +451,11 @@ void JT_Roster::onGo()
 
 const Roster &JT_Roster::roster() const { return d->roster; }
 
+/**
+ * \brief Returns true if the server replied the cached roster version is still actual
+ */
+bool JT_Roster::isRosterUnchanged() const { return d->rosterUnchanged; }
+
 QString JT_Roster::groupsDelimiter() const { return d->groupsDelimiter; }
 
 QString JT_Roster::toString() const
@@ -487,7 +501,9 @@ bool JT_Roster::take(const QDomElement &x)
     if (type == Get) {
         if (x.attribute("type") == "result") {
             QDomElement q = queryTag(x);
-            d->roster     = xmlReadRoster(q, false);
+            // XEP-0237: empty result means the roster wasn't changed since the version we sent
+            d->rosterUnchanged = q.isNull() && iq.firstChildElement().hasAttribute("ver");
+            d->roster          = xmlReadRoster(q, false);
             setSuccess();
         } else {
             setError(x);
@@ -93,7 +93,7 @@ public:
     JT_Roster(Task *parent);
     ~JT_Roster();
 
-    void get();
+    void get(const QString &version = QString());
     void set(const Jid &, const QString &name, const QStringList &groups);
     void remove(const Jid &);
 
@@ -102,6 +102,7 @@ public:
     void setGroupsDelimiter(const QString &groupsDelimiter);
 
     const Roster &roster() const;
+    bool          isRosterUnchanged() const;
     QString       groupsDelimiter() const;
 
     QString toString() const;
@@ -38,6 +38,7 @@ HEADERS += \
     $$PWD/xmpp-core/xmpp_clientstream.h \
     $$PWD/xmpp-core/xmpp.h \
     $$PWD/xmpp-core/xmpp_stanza.h \
+    $$PWD/xmpp-core/xmpp_streamcapture.h \
     $$PWD/xmpp-core/xmpp_stream.h \
     $$PWD/xmpp-im/filetransfer.h \
     $$PWD/xmpp-im/httpfileupload.h \
@@ -103,6 +104,7 @@ SOURCES += \
     $$PWD/xmpp-core/stream.cpp \
     $$PWD/xmpp-core/simplesasl.cpp \
     $$PWD/xmpp-core/xmpp_stanza.cpp \
+    $$PWD/xmpp-core/xmpp_streamcapture.cpp \
     $$PWD/xmpp-im/jingle-ice.cpp \
     $$PWD/xmpp-im/types.cpp \
     $$PWD/xmpp-im/client.cpp \
@@ -0,0 +1,137 @@
+/*
+ * zlibtest.cpp - ZLibCompressor/ZLibDecompressor tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "qttestutil/qttestutil.h"
+#include "xmpp/zlib/zlibcompressor.h"
+#include "xmpp/zlib/zlibdecompressor.h"
+
+#include <QBuffer>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QtTest/QtTest>
+
+// the compressor reconsiders its level after this much input (ADAPT_WINDOW)
+#define WINDOW (64 * 1024)
+
+class ZLibTest : public QObject {
+    Q_OBJECT
+
+private:
+    QBuffer           wire, plain;
+    ZLibCompressor *  compressor   = nullptr;
+    ZLibDecompressor *decompressor = nullptr;
+    qint64            wirePos      = 0;
+
+    // feeds whatever the compressor produced since the last call to the decompressor
+    QByteArray received()
+    {
+        QByteArray fresh = wire.data().mid(int(wirePos));
+        wirePos          = wire.data().size();
+        decompressor->write(fresh);
+        return plain.data();
+    }
+
+    static QByteArray stanzas(int count)
+    {
+        QByteArray ret;
+        for (int i = 0; i < count; ++i)
+            ret += QString("<message to='juliet@example.com' id='m%1'><body>Wherefore art thou, %1?</body></message>")
+                       .arg(i)
+                       .toUtf8();
+        return ret;
+    }
+
+    static QByteArray noise(int size)
+    {
+        QRandomGenerator gen(45);
+        QByteArray       ret(size, Qt::Uninitialized);
+        gen.fillRange(reinterpret_cast<quint32 *>(ret.data()), size / int(sizeof(quint32)));
+        return ret;
+    }
+
+private slots:
+    void init()
+    {
+        wire.setData(QByteArray());
+        plain.setData(QByteArray());
+        wire.open(QIODevice::WriteOnly);
+        plain.open(QIODevice::WriteOnly);
+        wirePos      = 0;
+        compressor   = new ZLibCompressor(&wire);
+        decompressor = new ZLibDecompressor(&plain);
+    }
+
+    void cleanup()
+    {
+        delete decompressor;
+        delete compressor;
+        wire.close();
+        plain.close();
+    }
+
+    void testDeferredSync()
+    {
+        QByteArray first  = stanzas(1);
+        QByteArray second = stanzas(3).mid(first.size());
+        QCOMPARE(compressor->write(first), 0);
+        QCOMPARE(compressor->write(second), 0);
+
+        // without a sync zlib holds the data back
+        QVERIFY(received().size() < first.size() + second.size());
+        QCOMPARE(compressor->statistics().syncs, qint64(0));
+
+        QCOMPARE(compressor->sync(), 0);
+        QCOMPARE(received(), first + second);
+        QCOMPARE(compressor->statistics().syncs, qint64(1));
+        QCOMPARE(compressor->statistics().plainBytes, qint64(first.size() + second.size()));
+        QCOMPARE(compressor->statistics().compressedBytes, qint64(wire.data().size()));
+
+        // a sync with nothing new keeps the stream intact
+        QCOMPARE(compressor->sync(), 0);
+        QCOMPARE(compressor->write(first), 0);
+        QCOMPARE(compressor->sync(), 0);
+        QCOMPARE(received(), first + second + first);
+    }
+
+    void testLevelSwitch()
+    {
+        QCOMPARE(compressor->statistics().level, int(Z_DEFAULT_COMPRESSION));
+
+        // random data doesn't compress, so the compressor backs off to the fastest level
+        QByteArray expected = noise(WINDOW);
+        QCOMPARE(compressor->write(expected), 0);
+        QCOMPARE(compressor->sync(), 0);
+        QCOMPARE(compressor->statistics().level, int(Z_BEST_SPEED));
+        QCOMPARE(received(), expected);
+
+        // the data written after deflateParams() still decodes, whichever level the cost measurement picks
+        QByteArray text = stanzas(WINDOW / 64);
+        QCOMPARE(compressor->write(text), 0);
+        QCOMPARE(compressor->sync(), 0);
+        expected += text;
+        QCOMPARE(received(), expected);
+
+        QCOMPARE(compressor->write(stanzas(10)), 0);
+        QCOMPARE(compressor->sync(), 0);
+        expected += stanzas(10);
+        QCOMPARE(received(), expected);
+    }
+};
+
+QTTESTUTIL_REGISTER_TEST(ZLibTest);
+#include "zlibtest.moc"
@@ -3,10 +3,20 @@
 #include "common.h"
 #include "zlib.h"
 
+#include <QElapsedTimer>
 #include <QIODevice>
 #include <QObject>
 #include <QtDebug>
 
+// the level is reconsidered after this much input
+#define ADAPT_WINDOW (64 * 1024) /* bytes */
+
+// output larger than this share of the input isn't worth the default level
+#define POOR_RATIO 0.85
+
+// deflate slower than this is cutting into the client's responsiveness
+#define SLOW_NSECS_PER_BYTE 100
+
 ZLibCompressor::ZLibCompressor(QIODevice *device, int compression) : device_(device)
 {
     zlib_stream_ = (z_stream *)malloc(sizeof(z_stream));
@@ -15,7 +25,9 @@ ZLibCompressor::ZLibCompressor(QIODevice *device, int compression) : device_(dev
     Q_ASSERT(result == Z_OK);
     Q_UNUSED(result);
     connect(device, SIGNAL(aboutToClose()), this, SLOT(flush()));
-    flushed_ = false;
+    flushed_      = false;
+    stats_.level  = compression;
+    window_.level = compression;
 }
 
 ZLibCompressor::~ZLibCompressor()
@@ -30,7 +42,7 @@ void ZLibCompressor::flush()
         return;
 
     // Flush
-    write(QByteArray(), true);
+    deflateAll(Z_FINISH);
     int result = deflateEnd(zlib_stream_);
     if (result != Z_OK)
         qWarning() << QString("compressor.c: deflateEnd failed (%1)").arg(result);
@@ -38,51 +50,97 @@ void ZLibCompressor::flush()
     flushed_ = true;
 }
 
-int ZLibCompressor::write(const QByteArray &input) { return write(input, false); }
-
-int ZLibCompressor::write(const QByteArray &input, bool flush)
+int ZLibCompressor::write(const QByteArray &input)
 {
-    int result;
     zlib_stream_->avail_in = uInt(input.size());
     zlib_stream_->next_in  = (Bytef *)input.data();
-    QByteArray output;
+    stats_.plainBytes += input.size();
+    window_.plainBytes += input.size();
+
+    int result = deflateAll(Z_NO_FLUSH);
+    if (zlib_stream_->avail_in != 0) {
+        qWarning("ZLibCompressor: avail_in != 0");
+    }
+    return result;
+}
+
+int ZLibCompressor::sync()
+{
+    int result = deflateAll(Z_SYNC_FLUSH);
+    ++stats_.syncs;
+    if (result == 0 && window_.plainBytes >= ADAPT_WINDOW)
+        adaptLevel();
+    return result;
+}
+
+// runs deflate until it has nothing more to say, growing the output arena
+//   as needed, and writes the result to the device
+int ZLibCompressor::deflateAll(int mode)
+{
+    QElapsedTimer timer;
+    timer.start();
 
-    // Write the data
+    int result;
     int output_position = 0;
     do {
-        output.resize(output_position + CHUNK_SIZE);
-        zlib_stream_->avail_out = CHUNK_SIZE;
-        zlib_stream_->next_out  = (Bytef *)(output.data() + output_position);
-        result                  = deflate(zlib_stream_, (flush ? Z_FINISH : Z_NO_FLUSH));
+        if (output_.size() - output_position < CHUNK_SIZE)
+            output_.resize(qMax(output_.size() * 2, output_position + CHUNK_SIZE));
+        zlib_stream_->avail_out = uInt(output_.size() - output_position);
+        zlib_stream_->next_out  = (Bytef *)(output_.data() + output_position);
+        result                  = deflate(zlib_stream_, mode);
         if (result == Z_STREAM_ERROR) {
             qWarning() << QString("compressor.cpp: Error ('%1')").arg(zlib_stream_->msg);
             return result;
         }
-        output_position += CHUNK_SIZE;
+        output_position = output_.size() - int(zlib_stream_->avail_out);
     } while (zlib_stream_->avail_out == 0);
-    if (zlib_stream_->avail_in != 0) {
-        qWarning("ZLibCompressor: avail_in != 0");
-    }
-    output_position -= zlib_stream_->avail_out;
-
-    // Flush the data
-    if (!flush) {
-        do {
-            output.resize(output_position + CHUNK_SIZE);
-            zlib_stream_->avail_out = CHUNK_SIZE;
-            zlib_stream_->next_out  = (Bytef *)(output.data() + output_position);
-            result                  = deflate(zlib_stream_, Z_SYNC_FLUSH);
-            if (result == Z_STREAM_ERROR) {
-                qWarning() << QString("compressor.cpp: Error ('%1')").arg(zlib_stream_->msg);
-                return result;
-            }
-            output_position += CHUNK_SIZE;
-        } while (zlib_stream_->avail_out == 0);
-        output_position -= zlib_stream_->avail_out;
-    }
-    output.resize(output_position);
+
+    qint64 nsecs = timer.nsecsElapsed();
+    stats_.nsecs += nsecs;
+    window_.nsecs += nsecs;
+    stats_.compressedBytes += output_position;
+    window_.compressedBytes += output_position;
 
     // Write the compressed data
-    device_->write(output);
+    if (output_position > 0)
+        device_->write(output_.constData(), output_position);
     return 0;
 }
+
+// pick the level from what the last window of traffic looked like: data that
+//   barely compresses (already compressed files, encrypted payloads) or that
+//   costs too much cpu goes with the fastest level, the rest with the default
+void ZLibCompressor::adaptLevel()
+{
+    double ratio = double(window_.compressedBytes) / double(window_.plainBytes);
+    qint64 cost  = window_.nsecs / window_.plainBytes;
+
+    int level;
+    if (ratio > POOR_RATIO || cost > SLOW_NSECS_PER_BYTE)
+        level = Z_BEST_SPEED;
+    else
+        level = Z_DEFAULT_COMPRESSION;
+
+    // a fast level is cheaper per byte, so only return to the default one
+    //   if it's expected to stay below the cost limit
+    if (level != window_.level && !(level == Z_DEFAULT_COMPRESSION && cost * 3 > SLOW_NSECS_PER_BYTE)) {
+        // the stream was just synced, so zlib has no pending input to
+        //   compress with the old parameters.  give it room anyway, in case
+        //   it wants to close the current block
+        zlib_stream_->avail_out = uInt(output_.size());
+        zlib_stream_->next_out  = (Bytef *)output_.data();
+        if (deflateParams(zlib_stream_, level, Z_DEFAULT_STRATEGY) == Z_OK)
+            stats_.level = level;
+        else
+            level = window_.level;
+        int written = output_.size() - int(zlib_stream_->avail_out);
+        if (written > 0) {
+            stats_.compressedBytes += written;
+            device_->write(output_.constData(), written);
+        }
+    } else
+        level = window_.level;
+
+    window_       = Statistics();
+    window_.level = level;
+}
@@ -3,6 +3,7 @@
 
 #include "zlib.h"
 
+#include <QByteArray>
 #include <QObject>
 
 class QIODevice;
@@ -11,21 +12,38 @@ class ZLibCompressor : public QObject {
     Q_OBJECT
 
 public:
+    struct Statistics {
+        qint64 plainBytes      = 0;
+        qint64 compressedBytes = 0;
+        qint64 syncs           = 0;
+        qint64 nsecs           = 0; // time spent in deflate()
+        int    level           = Z_DEFAULT_COMPRESSION;
+    };
+
     ZLibCompressor(QIODevice *device, int compression = Z_DEFAULT_COMPRESSION);
     ~ZLibCompressor();
 
+    // compresses without flushing, the output may be held back by zlib
     int write(const QByteArray &);
+    // pushes out everything written so far
+    int sync();
+
+    const Statistics &statistics() const { return stats_; }
 
 protected slots:
     void flush();
 
 protected:
-    int write(const QByteArray &, bool flush);
+    int  deflateAll(int mode);
+    void adaptLevel();
 
 private:
     QIODevice *device_;
     z_stream * zlib_stream_;
     bool       flushed_;
+    QByteArray output_; // reused between calls, never shrinks
+    Statistics stats_;
+    Statistics window_; // since the level was last reconsidered
 };
 
 #endif // ZLIBCOMPRESSOR_H
@@ -45,20 +45,20 @@ qint64 ZLibDecompressor::write(const QByteArray &input, bool flush)
     int result;
     zlib_stream_->avail_in = uInt(input.size());
     zlib_stream_->next_in  = (Bytef *)input.data();
-    QByteArray output;
 
     // Write the data
     int output_position = 0;
     do {
-        output.resize(output_position + CHUNK_SIZE);
-        zlib_stream_->avail_out = CHUNK_SIZE;
-        zlib_stream_->next_out  = (Bytef *)(output.data() + output_position);
-        result                  = inflate(zlib_stream_, (flush ? Z_FINISH : Z_NO_FLUSH));
+        if (output_.size() - output_position < CHUNK_SIZE)
+            output_.resize(qMax(output_.size() * 2, output_position + CHUNK_SIZE));
+        zlib_stream_->avail_out = uInt(output_.size() - output_position);
+        zlib_stream_->next_out  = (Bytef *)(output_.data() + output_position);
+        result                  = inflate(zlib_stream_, (flush ? Z_FINISH : Z_SYNC_FLUSH));
         if (result == Z_STREAM_ERROR) {
             qWarning() << QString("compressor.cpp: Error ('%1')").arg(zlib_stream_->msg);
             return result;
         }
-        output_position += CHUNK_SIZE;
+        output_position = output_.size() - int(zlib_stream_->avail_out);
     } while (zlib_stream_->avail_out == 0);
     // Q_ASSERT(zlib_stream_->avail_in == 0);
     if (zlib_stream_->avail_in != 0) {
@@ -66,26 +66,9 @@ qint64 ZLibDecompressor::write(const QByteArray &input, bool flush)
                    << ",avail_out=" << zlib_stream_->avail_out << ",result=" << result;
         return Z_STREAM_ERROR; // FIXME: Should probably return 'result'
     }
-    output_position -= zlib_stream_->avail_out;
 
-    // Flush the data
-    if (!flush) {
-        do {
-            output.resize(output_position + CHUNK_SIZE);
-            zlib_stream_->avail_out = CHUNK_SIZE;
-            zlib_stream_->next_out  = (Bytef *)(output.data() + output_position);
-            result                  = inflate(zlib_stream_, Z_SYNC_FLUSH);
-            if (result == Z_STREAM_ERROR) {
-                qWarning() << QString("compressor.cpp: Error ('%1')").arg(zlib_stream_->msg);
-                return result;
-            }
-            output_position += CHUNK_SIZE;
-        } while (zlib_stream_->avail_out == 0);
-        output_position -= zlib_stream_->avail_out;
-    }
-    output.resize(output_position);
-
-    // Write the compressed data
-    device_->write(output);
+    // Write the decompressed data
+    if (output_position > 0)
+        device_->write(output_.constData(), output_position);
     return 0;
 }
@@ -3,6 +3,7 @@
 
 #include "zlib.h"
 
+#include <QByteArray>
 #include <QObject>
 
 class QIODevice;
@@ -26,6 +27,7 @@ private:
     QIODevice *device_;
     z_stream * zlib_stream_;
     bool       flushed_;
+    QByteArray output_; // reused between calls, never shrinks
 };
 
 #endif // ZLIBDECOMPRESSOR_H
@@ -285,10 +285,12 @@ bool OMEMO::encryptMessage(const QString &ownJid, int account, QDomElement &xml,
     }
     QList<EncryptedKey> encryptedKeys;
     if (isGroup) {
+        QStringList participants;
         forEachMucParticipant(account, ownJid, recipient, [&](const QString &userJid) {
-            encryptedKeys.append(signal->encryptKey(ownJid, userJid, key));
+            participants.append(userJid);
             return true;
         });
+        encryptedKeys = signal->encryptKey(ownJid, participants, key);
     } else {
         encryptedKeys = signal->encryptKey(ownJid, recipient, key);
     }
@@ -157,6 +157,7 @@ void Signal::processBundle(const QString &from, uint32_t deviceId, const Bundle
                         == SG_SUCCESS) {
                         session_builder_process_pre_key_bundle(session_builder, pre_key_bundle);
                         session_builder_free(session_builder);
+                        m_storage.flush();
                     }
                     SIGNAL_UNREF(pre_key_bundle);
                 }
@@ -214,23 +215,40 @@ bool Signal::sessionIsValid(const signal_protocol_address &addr) const
 
 QList<EncryptedKey> Signal::encryptKey(const QString &ownJid, const QString &recipient, const QByteArray &key)
 {
-    QList<EncryptedKey> results;
-    const QByteArray   &recipientUtf8 = recipient.toUtf8();
-    const QByteArray   &ownJidUtf8    = ownJid.toUtf8();
+    return encryptKey(ownJid, QStringList { recipient }, key);
+}
 
-    QSet<uint32_t> ownDevices       = m_storage.getDeviceList(ownJid);
-    QSet<uint32_t> recipientDevices = m_storage.getDeviceList(recipient);
+QList<EncryptedKey> Signal::encryptKey(const QString &ownJid, const QStringList &recipients, const QByteArray &key)
+{
+    QList<EncryptedKey> results;
+    const QByteArray   &ownJidUtf8 = ownJid.toUtf8();
+
+    // own devices get the key just once, even if the message goes to many recipients
+    QList<QPair<QByteArray, uint32_t>> addresses;
+    QSet<uint32_t>                     ownDevices = m_storage.getDeviceList(ownJid);
+    for (const auto &recipient : recipients) {
+        QSet<uint32_t> recipientDevices = m_storage.getDeviceList(recipient);
+        if (recipientDevices.isEmpty())
+            continue;
 
-    if (recipientDevices.isEmpty()) {
+        const QByteArray &recipientUtf8 = recipient.toUtf8();
+        for (auto deviceId : qAsConst(recipientDevices)) {
+            if (deviceId != m_deviceId) {
+                addresses.append(qMakePair(recipientUtf8, deviceId));
+                ownDevices.remove(deviceId);
+            }
+        }
+    }
+    if (addresses.isEmpty()) {
         return results;
     }
+    for (auto deviceId : qAsConst(ownDevices)) {
+        if (deviceId != m_deviceId)
+            addresses.append(qMakePair(ownJidUtf8, deviceId));
+    }
 
-    QSet<uint32_t> devices;
-    devices.unite(ownDevices).unite(recipientDevices).remove(m_deviceId);
-
-    for (auto deviceId : devices) {
-        const QByteArray       &name = recipientDevices.contains(deviceId) ? recipientUtf8 : ownJidUtf8;
-        signal_protocol_address addr = getAddress(deviceId, name);
+    for (const auto &address : qAsConst(addresses)) {
+        signal_protocol_address addr = getAddress(address.second, address.first);
         if (!sessionIsValid(addr))
             continue;
 
@@ -249,6 +267,8 @@ QList<EncryptedKey> Signal::encryptKey(const QString &ownJid, const QString &rec
         }
     }
 
+    // all the updated sessions are written in one transaction
+    m_storage.flush();
     return results;
 }
 
@@ -297,6 +317,7 @@ QPair<QByteArray, bool> Signal::decryptKey(const QString &sender, const Encrypte
                          }
                      });
     }
+    m_storage.flush();
     return qMakePair(key, buildSessionWithPreKey);
 }
 
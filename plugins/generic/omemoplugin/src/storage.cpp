@@ -80,6 +80,12 @@ void Storage::init(signal_context *ctx, const QString &dataPath, const QString &
 
 void Storage::deinit()
 {
+    flush();
+    m_queries.clear();
+    m_values.clear();
+    m_sessions.clear();
+    m_identities.clear();
+
     db().exec("VACUUM");
     QSqlDatabase::database(m_databaseConnectionName).close();
     QSqlDatabase::removeDatabase(m_databaseConnectionName);
@@ -202,6 +208,84 @@ void Storage::migrateDatabase()
 
 QSqlDatabase Storage::db() const { return QSqlDatabase::database(m_databaseConnectionName); }
 
+// libsignal callbacks run the same few statements for every device, so they are prepared once
+QSqlQuery &Storage::query(const QString &sql) const
+{
+    auto it = m_queries.find(sql);
+    if (it == m_queries.end()) {
+        QSqlQuery q(db());
+        q.prepare(sql);
+        it = m_queries.insert(sql, q);
+    }
+    return it.value();
+}
+
+Storage::DeviceKey Storage::deviceKey(const signal_protocol_address *address)
+{
+    return DeviceKey(addrName(address), static_cast<uint32_t>(address->device_id));
+}
+
+QByteArray Storage::session(const signal_protocol_address *address) const
+{
+    auto key = deviceKey(address);
+    auto it  = m_sessions.constFind(key);
+    if (it != m_sessions.constEnd())
+        return it.value();
+
+    QSqlQuery &q = query("SELECT session FROM session_store WHERE jid IS ? AND device_id IS ?");
+    q.bindValue(0, key.first);
+    q.bindValue(1, key.second);
+    q.exec();
+    QByteArray data = q.next() ? q.value(0).toByteArray() : QByteArray();
+    q.finish();
+    m_sessions.insert(key, data);
+    return data;
+}
+
+QByteArray Storage::identity(const signal_protocol_address *address) const
+{
+    auto key = deviceKey(address);
+    auto it  = m_identities.constFind(key);
+    if (it != m_identities.constEnd())
+        return it.value();
+
+    QSqlQuery &q = query("SELECT key FROM identity_key_store WHERE jid IS ? AND device_id IS ?");
+    q.bindValue(0, key.first);
+    q.bindValue(1, key.second);
+    q.exec();
+    QByteArray data = q.next() ? q.value(0).toByteArray() : QByteArray();
+    q.finish();
+    m_identities.insert(key, data);
+    return data;
+}
+
+void Storage::flush()
+{
+    if (m_dirtySessions.isEmpty() && m_removedPreKeys.isEmpty())
+        return;
+
+    QSqlDatabase _db = db();
+    _db.transaction();
+
+    QSqlQuery &q = query("INSERT OR REPLACE INTO session_store (jid, device_id, session) VALUES (?, ?, ?)");
+    for (const auto &key : qAsConst(m_dirtySessions)) {
+        q.bindValue(0, key.first);
+        q.bindValue(1, key.second);
+        q.bindValue(2, m_sessions.value(key));
+        q.exec();
+    }
+
+    QSqlQuery &q2 = query("DELETE FROM pre_key_store WHERE id IS ?");
+    for (auto id : qAsConst(m_removedPreKeys)) {
+        q2.bindValue(0, id);
+        q2.exec();
+    }
+
+    _db.commit();
+    m_dirtySessions.clear();
+    m_removedPreKeys.clear();
+}
+
 QMap<uint32_t, QByteArray> Storage::getKeysMap(const QString &user)
 {
     QSqlQuery q(db());
@@ -332,6 +416,7 @@ void Storage::updateDeviceList(const QString &user, const QSet<uint32_t> &actual
 
 QVector<QPair<uint32_t, QByteArray>> Storage::loadAllPreKeys(int limit)
 {
+    flush();
     QVector<QPair<uint32_t, QByteArray>> results;
     QSqlQuery                            q(db());
     q.prepare("SELECT id, pre_key FROM pre_key_store ORDER BY id ASC limit ?");
@@ -345,6 +430,7 @@ QVector<QPair<uint32_t, QByteArray>> Storage::loadAllPreKeys(int limit)
 
 uint32_t Storage::preKeyCount()
 {
+    flush();
     QSqlQuery q(db());
     q.prepare("SELECT COUNT(*) FROM pre_key_store");
     q.exec();
@@ -354,6 +440,7 @@ uint32_t Storage::preKeyCount()
 
 uint32_t Storage::maxPreKeyId()
 {
+    flush();
     QSqlQuery q(db());
     q.prepare("SELECT MAX(id) FROM pre_key_store");
     q.exec();
@@ -363,6 +450,7 @@ uint32_t Storage::maxPreKeyId()
 
 void Storage::storePreKeys(QVector<QPair<uint32_t, QByteArray>> keys)
 {
+    flush();
     QSqlDatabase database = db();
     QSqlQuery    q(database);
     q.prepare("INSERT INTO pre_key_store (id, pre_key) VALUES (?, ?)");
@@ -400,16 +488,6 @@ int Storage::toSignalBuffer(const QVariant &q, signal_buffer **record)
     return 1;
 }
 
-QSqlQuery Storage::lookupSession(const signal_protocol_address *address, const void *user_data)
-{
-    QSqlQuery q = getQuery(user_data);
-    q.prepare("SELECT session FROM session_store WHERE jid IS ? AND device_id IS ?");
-    q.addBindValue(addrName(address));
-    q.addBindValue(address->device_id);
-    q.exec();
-    return q;
-}
-
 #ifdef OLD_SIGNAL
 int Storage::loadSession(signal_buffer **record, const signal_protocol_address *address, void *user_data)
 {
@@ -419,8 +497,8 @@ int Storage::loadSession(signal_buffer **record, signal_buffer **user_record, co
 {
     (void)user_record;
 #endif
-    QSqlQuery q = lookupSession(address, user_data);
-    return q.next() ? toSignalBuffer(q.value(0), record) : 0;
+    QByteArray data = static_cast<Storage *>(user_data)->session(address);
+    return data.isNull() ? 0 : toSignalBuffer(data, record);
 }
 
 #ifdef OLD_SIGNAL
@@ -433,35 +511,38 @@ int Storage::storeSession(const signal_protocol_address *address, uint8_t *recor
     (void)user_record;
     (void)user_record_len;
 #endif
-    QSqlQuery q = getQuery(user_data);
-    q.prepare("INSERT OR REPLACE INTO session_store (jid, device_id, session) VALUES (?, ?, ?)");
-    q.addBindValue(addrName(address));
-    q.addBindValue(address->device_id);
-    q.addBindValue(QByteArray(reinterpret_cast<char *>(record), static_cast<int>(record_len)));
-    return q.exec() ? SG_SUCCESS : -1;
+    // written to the database on flush()
+    auto storage = static_cast<Storage *>(user_data);
+    auto key     = deviceKey(address);
+    storage->m_sessions.insert(key, QByteArray(reinterpret_cast<char *>(record), static_cast<int>(record_len)));
+    storage->m_dirtySessions.insert(key);
+    return SG_SUCCESS;
 }
 
 int Storage::containsSession(const signal_protocol_address *address, void *user_data)
 {
-    QSqlQuery q = lookupSession(address, user_data);
-    return q.next() ? 1 : 0;
+    return static_cast<Storage *>(user_data)->session(address).isNull() ? 0 : 1;
 }
 
 int Storage::loadPreKey(signal_buffer **record, uint32_t pre_key_id, void *user_data)
 {
-    QSqlQuery q = getQuery(user_data);
-    q.prepare("SELECT pre_key FROM pre_key_store WHERE id IS ?");
-    q.addBindValue(pre_key_id);
+    auto storage = static_cast<Storage *>(user_data);
+    if (storage->m_removedPreKeys.contains(pre_key_id))
+        return SG_ERR_INVALID_KEY_ID;
+
+    QSqlQuery &q = storage->query("SELECT pre_key FROM pre_key_store WHERE id IS ?");
+    q.bindValue(0, pre_key_id);
     q.exec();
-    return q.next() ? toSignalBuffer(q.value(0), record) : SG_ERR_INVALID_KEY_ID;
+    int ret = q.next() ? toSignalBuffer(q.value(0), record) : SG_ERR_INVALID_KEY_ID;
+    q.finish();
+    return ret;
 }
 
 int Storage::removePreKey(uint32_t pre_key_id, void *user_data)
 {
-    QSqlQuery q = getQuery(user_data);
-    q.prepare("DELETE FROM pre_key_store WHERE id IS ?");
-    q.addBindValue(pre_key_id);
-    return q.exec() ? SG_SUCCESS : -1;
+    // deleted from the database on flush()
+    static_cast<Storage *>(user_data)->m_removedPreKeys.insert(pre_key_id);
+    return SG_SUCCESS;
 }
 
 int Storage::loadSignedPreKey(signal_buffer **record, uint32_t signed_pre_key_id, void *user_data)
@@ -495,20 +576,29 @@ int Storage::getIdentityKeyPair(signal_buffer **public_data, signal_buffer **pri
 
 QVariant Storage::lookupValue(void *user_data, const QString &key)
 {
-    QSqlQuery q = getQuery(user_data);
-    q.prepare("SELECT value FROM simple_store WHERE key IS ?");
-    q.addBindValue(key);
+    auto storage = static_cast<Storage *>(user_data);
+    auto it      = storage->m_values.constFind(key);
+    if (it != storage->m_values.constEnd())
+        return it.value();
+
+    QSqlQuery &q = storage->query("SELECT value FROM simple_store WHERE key IS ?");
+    q.bindValue(0, key);
     q.exec();
-    return q.next() ? q.value(0) : QVariant();
+    QVariant value = q.next() ? q.value(0) : QVariant();
+    q.finish();
+    storage->m_values.insert(key, value);
+    return value;
 }
 
 void Storage::storeValue(const QString &key, const QVariant &value)
 {
-    QSqlQuery q(db());
-    q.prepare("INSERT OR REPLACE INTO simple_store (key, value) VALUES (?, ?)");
-    q.addBindValue(key);
-    q.addBindValue(value);
-    q.exec();
+    QSqlQuery &q = query("INSERT OR REPLACE INTO simple_store (key, value) VALUES (?, ?)");
+    q.bindValue(0, key);
+    q.bindValue(1, value);
+    if (q.exec())
+        m_values.insert(key, value);
+    else
+        m_values.remove(key);
 }
 
 int Storage::getLocalRegistrationId(void *user_data, uint32_t *registration_id)
@@ -521,29 +611,31 @@ int Storage::getLocalRegistrationId(void *user_data, uint32_t *registration_id)
     return SG_SUCCESS;
 }
 
-bool Storage::identityExists(const signal_protocol_address *addr_p) const
-{
-    QSqlQuery q(db());
-    q.prepare("SELECT COUNT(*) FROM identity_key_store WHERE jid IS ? AND device_id IS ?");
-    q.addBindValue(addrName(addr_p));
-    q.addBindValue(addr_p->device_id);
-    q.exec();
-    return q.next() && q.value(0).toInt() == 1;
-}
+bool Storage::identityExists(const signal_protocol_address *addr_p) const { return !identity(addr_p).isNull(); }
 
 int Storage::saveIdentity(const signal_protocol_address *addr_p, uint8_t *key_data, size_t key_len, void *user_data)
 {
-    QSqlQuery q = getQuery(user_data);
+    // identities are written through since other queries join them with the devices
+    auto       storage = static_cast<Storage *>(user_data);
+    auto       key     = deviceKey(addr_p);
+    QByteArray data;
+    QSqlQuery  q = getQuery(user_data);
 
     if (key_data != nullptr) {
+        data = QByteArray(reinterpret_cast<char *>(key_data), static_cast<int>(key_len));
         q.prepare("INSERT OR REPLACE INTO identity_key_store (key, jid, device_id) VALUES (?, ?, ?)");
-        q.addBindValue(QByteArray(reinterpret_cast<char *>(key_data), static_cast<int>(key_len)));
+        q.addBindValue(data);
     } else {
         q.prepare("DELETE FROM identity_key_store WHERE jid IS ? AND device_id IS ?");
     }
-    q.addBindValue(addrName(addr_p));
-    q.addBindValue(addr_p->device_id);
-    return q.exec() ? SG_SUCCESS : -1;
+    q.addBindValue(key.first);
+    q.addBindValue(key.second);
+    if (!q.exec()) {
+        storage->m_identities.remove(key);
+        return -1;
+    }
+    storage->m_identities.insert(key, data);
+    return SG_SUCCESS;
 }
 
 int Storage::isTrustedIdentity(const signal_protocol_address *addr_p, uint8_t *key_data, size_t key_len,
@@ -570,17 +662,12 @@ bool Storage::isTrusted(QString const &user, uint32_t deviceId)
 
 QByteArray Storage::loadDeviceIdentity(const QString &user, uint32_t deviceId)
 {
-    QSqlQuery q(db());
-    q.prepare("SELECT key FROM identity_key_store WHERE jid IS ? AND device_id IS ?");
-    q.addBindValue(user);
-    q.addBindValue(deviceId);
-    q.exec();
-
-    QByteArray res;
-    if (q.next()) {
-        res = q.value(0).toByteArray();
-    }
-    return res;
+    const QByteArray        name = user.toUtf8();
+    signal_protocol_address addr = {};
+    addr.name                    = name.data();
+    addr.name_len                = static_cast<size_t>(name.size());
+    addr.device_id               = static_cast<int32_t>(deviceId);
+    return identity(&addr);
 }
 
 void Storage::removeDevice(const QString &user, uint32_t deviceId)
@@ -620,6 +707,13 @@ void Storage::setDeviceTrust(const QString &user, uint32_t deviceId, bool truste
 
 void Storage::removeCurrentDevice()
 {
+    m_queries.clear();
+    m_values.clear();
+    m_sessions.clear();
+    m_identities.clear();
+    m_dirtySessions.clear();
+    m_removedPreKeys.clear();
+
     QSqlDatabase _db(db());
     QSqlQuery    q(_db);
 
@@ -61,21 +61,36 @@ public:
     void                           setEnabledForUser(const QString &user, bool value);
     void                           setDisabledForUser(const QString &user, bool value);
 
+    // writes session and pre-key changes made by libsignal callbacks in one transaction
+    void flush();
+
 private:
+    using DeviceKey = QPair<QString, uint32_t>;
+
     QString m_databaseConnectionName;
 
     signal_protocol_store_context *m_storeContext = nullptr;
 
+    mutable QHash<QString, QSqlQuery>    m_queries;    // prepared statements by their sql
+    mutable QHash<QString, QVariant>     m_values;     // simple_store
+    mutable QHash<DeviceKey, QByteArray> m_sessions;   // null value means there is no session
+    mutable QHash<DeviceKey, QByteArray> m_identities; // null value means there is no identity
+    QSet<DeviceKey>                      m_dirtySessions;
+    QSet<uint32_t>                       m_removedPreKeys;
+
     void initializeDB(signal_context *signalContext);
     void migrateDatabase();
 
     QSqlDatabase     db() const;
+    QSqlQuery       &query(const QString &sql) const;
+    QByteArray       session(const signal_protocol_address *address) const;
+    QByteArray       identity(const signal_protocol_address *address) const;
+    static DeviceKey deviceKey(const signal_protocol_address *address);
     static QSqlQuery getQuery(const void *user_data);
     static QString   toQString(const char *name, size_t name_len);
     static QString   addrName(const signal_protocol_address *address);
 
-    static int       toSignalBuffer(const QVariant &q, signal_buffer **record);
-    static QSqlQuery lookupSession(const signal_protocol_address *address, const void *user_data);
+    static int toSignalBuffer(const QVariant &q, signal_buffer **record);
 #ifdef OLD_SIGNAL
     static int loadSession(signal_buffer **record, const signal_protocol_address *address, void *user_data);
     static int storeSession(const signal_protocol_address *address, uint8_t *record, size_t record_len,
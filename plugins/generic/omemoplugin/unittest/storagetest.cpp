@@ -0,0 +1,155 @@
+#include "crypto.h"
+#include "storage.h"
+
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+extern "C" {
+#include "key_helper.h"
+#include "session_pre_key.h"
+#include "session_record.h"
+}
+
+using namespace psiomemo;
+
+class StorageTest : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir           dir;
+    signal_context *        ctx = nullptr;
+    Storage                 storage;
+    const QByteArray        name = "alice@example.org";
+    signal_protocol_address addr = { name.constData(), size_t(name.size()), 1 };
+
+    // what is on disk, as seen by another connection
+    int countRows(const QString &table, const QString &where = QString())
+    {
+        int ret = -1;
+        {
+            auto db = QSqlDatabase::addDatabase("QSQLITE", "probe");
+            db.setDatabaseName(dir.filePath("omemo-test.sqlite"));
+            db.open();
+            QSqlQuery q(db);
+            q.exec("SELECT COUNT(*) FROM " + table + (where.isEmpty() ? QString() : " WHERE " + where));
+            if (q.next())
+                ret = q.value(0).toInt();
+        }
+        QSqlDatabase::removeDatabase("probe");
+        return ret;
+    }
+
+    QByteArray serialize(session_record *record)
+    {
+        signal_buffer *buf = nullptr;
+        if (session_record_serialize(&buf, record) != SG_SUCCESS)
+            return QByteArray();
+        QByteArray ret = toQByteArray(buf);
+        signal_buffer_free(buf);
+        return ret;
+    }
+
+    void reopen()
+    {
+        storage.deinit();
+        storage.init(ctx, dir.path(), "test");
+    }
+
+private slots:
+    void init()
+    {
+        QVERIFY(dir.isValid());
+        signal_context_create(&ctx, nullptr);
+        Crypto::initCryptoProvider(ctx);
+        storage.init(ctx, dir.path(), "test");
+    }
+
+    void cleanup()
+    {
+        storage.removeCurrentDevice();
+        storage.deinit();
+        signal_context_destroy(ctx);
+        ctx = nullptr;
+    }
+
+    void testSessionWriteBack()
+    {
+        auto store = storage.storeContext();
+        QCOMPARE(signal_protocol_session_contains_session(store, &addr), 0);
+
+        session_record *record = nullptr;
+        QCOMPARE(session_record_create(&record, nullptr, ctx), int(SG_SUCCESS));
+        QByteArray stored = serialize(record);
+        QCOMPARE(signal_protocol_session_store_session(store, &addr, record), int(SG_SUCCESS));
+        SIGNAL_UNREF(record);
+
+        // visible through the cache before it reaches the database
+        QCOMPARE(signal_protocol_session_contains_session(store, &addr), 1);
+        QCOMPARE(signal_protocol_session_load_session(store, &record, &addr), int(SG_SUCCESS));
+        QCOMPARE(serialize(record), stored);
+        SIGNAL_UNREF(record);
+        QCOMPARE(countRows("session_store"), 0);
+
+        storage.flush();
+        QCOMPARE(countRows("session_store"), 1);
+        QCOMPARE(signal_protocol_session_load_session(store, &record, &addr), int(SG_SUCCESS));
+        QCOMPARE(serialize(record), stored);
+        SIGNAL_UNREF(record);
+
+        // and read back from the database with an empty cache
+        reopen();
+        store = storage.storeContext();
+        QCOMPARE(signal_protocol_session_contains_session(store, &addr), 1);
+        QCOMPARE(signal_protocol_session_load_session(store, &record, &addr), int(SG_SUCCESS));
+        QCOMPARE(serialize(record), stored);
+        SIGNAL_UNREF(record);
+    }
+
+    void testDeinitFlushes()
+    {
+        session_record *record = nullptr;
+        QCOMPARE(session_record_create(&record, nullptr, ctx), int(SG_SUCCESS));
+        signal_protocol_session_store_session(storage.storeContext(), &addr, record);
+        SIGNAL_UNREF(record);
+
+        reopen();
+        QCOMPARE(countRows("session_store"), 1);
+        QCOMPARE(signal_protocol_session_contains_session(storage.storeContext(), &addr), 1);
+    }
+
+    void testPreKeyRemoval()
+    {
+        signal_protocol_key_helper_pre_key_list_node *head = nullptr;
+        QCOMPARE(signal_protocol_key_helper_generate_pre_keys(&head, 1, 3, ctx), int(SG_SUCCESS));
+        QVector<QPair<uint32_t, QByteArray>> keys;
+        for (auto node = head; node; node = signal_protocol_key_helper_key_list_next(node)) {
+            session_pre_key *key = signal_protocol_key_helper_key_list_element(node);
+            signal_buffer *  buf = nullptr;
+            QCOMPARE(session_pre_key_serialize(&buf, key), int(SG_SUCCESS));
+            keys.append(qMakePair(session_pre_key_get_id(key), toQByteArray(buf)));
+            signal_buffer_bzero_free(buf);
+        }
+        signal_protocol_key_helper_key_list_free(head);
+        storage.storePreKeys(keys);
+
+        auto             store = storage.storeContext();
+        session_pre_key *key   = nullptr;
+        QCOMPARE(signal_protocol_pre_key_load_key(store, &key, 2), int(SG_SUCCESS));
+        SIGNAL_UNREF(key);
+
+        QCOMPARE(signal_protocol_pre_key_remove_key(store, 2), int(SG_SUCCESS));
+        // gone for libsignal right away, still on disk until flushed
+        QCOMPARE(signal_protocol_pre_key_load_key(store, &key, 2), int(SG_ERR_INVALID_KEY_ID));
+        QCOMPARE(countRows("pre_key_store", "id = 2"), 1);
+
+        // queries over the table flush first
+        QCOMPARE(storage.preKeyCount(), 2u);
+        QCOMPARE(countRows("pre_key_store", "id = 2"), 0);
+        QCOMPARE(signal_protocol_pre_key_load_key(store, &key, 2), int(SG_ERR_INVALID_KEY_ID));
+        QCOMPARE(signal_protocol_pre_key_load_key(store, &key, 3), int(SG_SUCCESS));
+        SIGNAL_UNREF(key);
+    }
+};
+
+QTEST_MAIN(StorageTest)
+#include "storagetest.moc"
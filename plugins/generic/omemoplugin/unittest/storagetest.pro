@@ -0,0 +1,29 @@
+# unittest helpers
+TARGET = storagetest
+CONFIG += unittest c++11
+TESTBASEDIR = ../../../../unittest
+include($$TESTBASEDIR/unittest.pri)
+
+QT += sql
+
+unix {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += libsignal-protocol-c libcrypto
+}
+
+load(configure)
+QMAKE_CONFIG_TESTS_DIR = ../config.tests
+qtCompileTest(oldSignal):DEFINES += OLD_SIGNAL
+
+INCLUDEPATH += ../src
+DEPENDPATH  += ../src
+
+SOURCES += \
+    storagetest.cpp \
+    ../src/crypto_common.cpp \
+    ../src/crypto_ossl.cpp \
+    ../src/storage.cpp
+
+HEADERS += \
+    ../src/crypto.h \
+    ../src/storage.h
@@ -33,12 +33,20 @@
 //   sense in keeping ancient data around.  we just drop and move on.
 #define QUEUE_PACKET_MAX 25
 
-// don't wake the main thread more often than this, for performance reasons
-#define WAKE_PACKET_MIN 40
+// don't wake the receiving thread for every packet: a batch is handed over
+//   once it reaches the watermark, or after the deadline otherwise
+#define WAKE_PACKET_MIN 8
+#define WAKE_DEADLINE 5 /* ms */
 
 namespace PsiMedia {
 
-GstRtpChannel::GstRtpChannel() { }
+GstRtpChannel::GstRtpChannel()
+{
+    // parented, so it follows the channel to the thread that reads it
+    wake_timer = new QTimer(this);
+    wake_timer->setSingleShot(true);
+    connect(wake_timer, &QTimer::timeout, this, &GstRtpChannel::processIn);
+}
 
 QObject *GstRtpChannel::qobject() { return this; }
 
@@ -48,6 +56,12 @@ void GstRtpChannel::setEnabled(bool b)
     enabled = b;
 }
 
+PRtpChannelStats GstRtpChannel::stats() const
+{
+    QMutexLocker locker(&m);
+    return stats_;
+}
+
 int GstRtpChannel::packetsAvailable() const { return in.count(); }
 
 PRtpPacket GstRtpChannel::read() { return in.takeFirst(); }
@@ -61,9 +75,10 @@ void GstRtpChannel::receiver_push_packet_for_write(const PRtpPacket &rtp)
 void GstRtpChannel::write(const PRtpPacket &rtp)
 {
     m.lock();
-    if (!enabled)
-        return;
+    bool ok = enabled;
     m.unlock();
+    if (!ok)
+        return;
 
     receiver_push_packet_for_write(rtp);
     ++written_pending;
@@ -79,32 +94,81 @@ void GstRtpChannel::push_packet_for_read(const PRtpPacket &rtp)
     if (!enabled)
         return;
 
+    ++stats_.received;
+
     // if the queue is full, bump off the oldest to make room
-    if (pending_in.count() >= QUEUE_PACKET_MAX)
+    if (pending_in.count() >= QUEUE_PACKET_MAX) {
         pending_in.removeFirst();
+        ++stats_.dropped;
+    }
 
     pending_in += rtp;
+    if (pending_in.count() > stats_.maxDepth)
+        stats_.maxDepth = pending_in.count();
 
-    // TODO: use WAKE_PACKET_MIN and wake_time ?
-
-    if (!wake_pending) {
-        wake_pending = true;
+    // one wake per batch: a full batch goes right away, otherwise the first
+    //   packet arms the deadline and everything arriving until then rides along
+    if (pending_in.count() >= WAKE_PACKET_MIN && !wake_now) {
+        wake_now = true;
         QMetaObject::invokeMethod(this, "processIn", Qt::QueuedConnection);
+    } else if (!wake_pending) {
+        wake_pending = true;
+        wake_time.start();
+        QMetaObject::invokeMethod(this, "armWakeTimer", Qt::QueuedConnection);
     }
 }
 
+void GstRtpChannel::armWakeTimer()
+{
+    m.lock();
+    // nothing to arm if the batch already went out on the watermark
+    bool   armed = wake_pending && !wake_now;
+    qint64 left  = WAKE_DEADLINE - wake_time.elapsed();
+    m.unlock();
+
+    if (!armed)
+        return;
+    if (left <= 0)
+        processIn();
+    else
+        wake_timer->start(int(left));
+}
+
 void GstRtpChannel::processIn()
 {
-    int oldcount = in.count();
+    QList<PRtpPacket> batch;
 
+    wake_timer->stop();
     m.lock();
     wake_pending = false;
-    in += pending_in;
-    pending_in.clear();
+    wake_now     = false;
+    batch.swap(pending_in);
+    if (!batch.isEmpty() && wake_time.isValid()) {
+        qint64 latency = wake_time.elapsed();
+        if (latency > stats_.maxLatency)
+            stats_.maxLatency = latency;
+    }
     m.unlock();
 
-    if (in.count() > oldcount)
-        emit readyRead();
+    if (batch.isEmpty())
+        return;
+
+    // hand the batch over without copying if the reader kept up, which is
+    //   the common case.  otherwise apply the same cap as above
+    if (in.isEmpty())
+        in.swap(batch);
+    else {
+        in += batch;
+        int excess = in.count() - QUEUE_PACKET_MAX;
+        if (excess > 0) {
+            in.erase(in.begin(), in.begin() + excess);
+            m.lock();
+            stats_.dropped += quint64(excess);
+            m.unlock();
+        }
+    }
+
+    emit readyRead();
 }
 
 void GstRtpChannel::processOut()
@@ -23,8 +23,10 @@
 
 #include "psimediaprovider.h"
 
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QObject>
+#include <QTimer>
 
 namespace PsiMedia {
 
@@ -36,13 +38,16 @@ class GstRtpChannel : public QObject, public RtpChannelContext {
 
 public:
     bool                  enabled = false;
-    QMutex                m;
+    mutable QMutex        m;
     GstRtpSessionContext *session = nullptr;
     QList<PRtpPacket>     in;
 
-    // QTime wake_time;
-    bool              wake_pending = false;
+    QElapsedTimer     wake_time;            // started when the first packet of a batch arrives
+    bool              wake_pending = false; // a wake for the current batch is on its way
+    bool              wake_now     = false; // the batch hit the watermark, processIn() is queued
+    QTimer *          wake_timer   = nullptr;
     QList<PRtpPacket> pending_in;
+    PRtpChannelStats  stats_;
 
     int written_pending = 0;
 
@@ -58,6 +63,8 @@ public:
 
     virtual void write(const PRtpPacket &rtp);
 
+    virtual PRtpChannelStats stats() const;
+
     // session calls this, which may be in another thread
     void push_packet_for_read(const PRtpPacket &rtp);
 
@@ -66,6 +73,8 @@ Q_SIGNALS:
     void packetsWritten(int count);
 
 private Q_SLOTS:
+    void armWakeTimer();
+
     void processIn();
 
     void processOut();
@@ -23,6 +23,7 @@
 #include <QPainter>
 #include <QPalette>
 #include <QWidget>
+#include <QtConcurrentRun>
 
 namespace PsiMedia {
 
@@ -35,14 +36,50 @@ GstVideoWidget::GstVideoWidget(VideoWidgetContext *_context, QObject *parent) :
 
     connect(context->qobject(), SIGNAL(resized(const QSize &)), SLOT(context_resized(const QSize &)));
     connect(context->qobject(), SIGNAL(paintEvent(QPainter *)), SLOT(context_paintEvent(QPainter *)));
+    connect(&scaler, SIGNAL(finished()), SLOT(scaler_finished()));
 }
 
+GstVideoWidget::~GstVideoWidget() { scaler.waitForFinished(); }
+
 void GstVideoWidget::show_frame(const QImage &image)
 {
-    curImage = image;
+    curImage    = image;
+    scaledImage = QImage();
     context->qwidget()->update();
 }
 
+// scale off the gui thread.  only one job runs at a time: frames arriving
+//   meanwhile are painted with a cheap scale until the job catches up
+void GstVideoWidget::startScaling(const QSize &size)
+{
+    if (scaler.isRunning())
+        return;
+
+    scalerSource = curImage.cacheKey();
+    scalerSize   = size;
+    QImage src   = curImage;
+    // the IgnoreAspectRatio is okay here, since the caller used KeepAspectRatio
+    scaler.setFuture(QtConcurrent::run(
+        [src, size]() { return src.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation); }));
+}
+
+void GstVideoWidget::scaler_finished()
+{
+    QImage i = scaler.result();
+    if (scalerSource == curImage.cacheKey() && scalerSize == targetSize()) {
+        scaledImage = i;
+        context->qwidget()->update();
+    } else if (!curImage.isNull())
+        context->qwidget()->update(); // a newer frame or size is waiting for its turn
+}
+
+QSize GstVideoWidget::targetSize() const
+{
+    QSize newSize = curImage.size();
+    newSize.scale(context->qwidget()->size(), Qt::KeepAspectRatio);
+    return newSize;
+}
+
 void GstVideoWidget::context_resized(const QSize &newSize) { Q_UNUSED(newSize); }
 
 void GstVideoWidget::context_paintEvent(QPainter *p)
@@ -51,26 +88,28 @@ void GstVideoWidget::context_paintEvent(QPainter *p)
         return;
 
     QSize size    = context->qwidget()->size();
-    QSize newSize = curImage.size();
-    newSize.scale(size, Qt::KeepAspectRatio);
-    int xoff = 0;
-    int yoff = 0;
+    QSize newSize = targetSize();
+    int   xoff    = 0;
+    int   yoff    = 0;
     if (newSize.width() < size.width())
         xoff = (size.width() - newSize.width()) / 2;
     else if (newSize.height() < size.height())
         yoff = (size.height() - newSize.height()) / 2;
 
-    // ideally, the backend will follow desired_size() and give
-    //   us images that generally don't need resizing
-    QImage i;
-    if (curImage.size() != newSize) {
-        // the IgnoreAspectRatio is okay here, since we
-        //   used KeepAspectRatio earlier
-        i = curImage.scaled(newSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-    } else
-        i = curImage;
-
-    p->drawImage(xoff, yoff, i);
+    if (curImage.size() == newSize) {
+        p->drawImage(xoff, yoff, curImage);
+        return;
+    }
+
+    if (scaledImage.size() == newSize) {
+        p->drawImage(xoff, yoff, scaledImage);
+        return;
+    }
+
+    // no smooth copy for this frame and size yet.  draw a fast one straight
+    //   from the frame and have the nice one made in the background
+    p->drawImage(QRect(QPoint(xoff, yoff), newSize), curImage);
+    startScaling(newSize);
 }
 
 } // namespace PsiMedia
@@ -23,6 +23,7 @@
 
 #include "psimediaprovider.h"
 
+#include <QFutureWatcher>
 #include <QImage>
 
 namespace PsiMedia {
@@ -36,14 +37,25 @@ class GstVideoWidget : public QObject {
 public:
     VideoWidgetContext *context;
     QImage              curImage;
+    QImage              scaledImage; // curImage at the widget's size, if ready
 
     explicit GstVideoWidget(VideoWidgetContext *_context, QObject *parent = nullptr);
+    ~GstVideoWidget() override;
 
     void show_frame(const QImage &image);
 
 private Q_SLOTS:
     void context_resized(const QSize &newSize);
     void context_paintEvent(QPainter *p);
+    void scaler_finished();
+
+private:
+    QFutureWatcher<QImage> scaler;
+    qint64                 scalerSource = 0; // cacheKey of the frame being scaled
+    QSize                  scalerSize;       // size the frame is being scaled to
+
+    void  startScaling(const QSize &size);
+    QSize targetSize() const; // curImage fitted into the widget
 };
 
 } // namespace PsiMedia
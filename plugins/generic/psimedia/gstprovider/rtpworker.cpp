@@ -1737,6 +1737,22 @@ bool RtpWorker::updateTheoraConfig()
     return false;
 }
 
+// the frame's QImage borrows the mapped sample memory, this hands it back
+//   once the last copy of the image goes away (from whatever thread that is)
+struct MappedSample {
+    GstSample * sample;
+    GstBuffer * buffer;
+    GstMapInfo  map;
+};
+
+static void releaseMappedSample(void *info)
+{
+    auto ms = static_cast<MappedSample *>(info);
+    gst_buffer_unmap(ms->buffer, &ms->map);
+    gst_sample_unref(ms->sample);
+    delete ms;
+}
+
 RtpWorker::Frame RtpWorker::Frame::pullFromSink(GstAppSink *appsink)
 {
     Frame      frame;
@@ -1757,13 +1773,18 @@ RtpWorker::Frame RtpWorker::Frame::pullFromSink(GstAppSink *appsink)
     gst_structure_get_int(capsStruct, "height", &height);
 
     if (gsize(width * height * 4) == gst_buffer_get_size(buffer)) {
-        QImage image(width, height, QImage::Format_RGB32);
-#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
-        gst_buffer_extract(buffer, 0, image.bits(), gsize(image.sizeInBytes()));
-#else
-        gst_buffer_extract(buffer, 0, image.bits(), image.byteCount());
-#endif
-        frame.image = image;
+        // wrap the buffer memory rather than copying it out.  the image is
+        //   read-only, so anything that wants to modify it detaches first
+        auto ms    = new MappedSample;
+        ms->sample = sample;
+        ms->buffer = buffer;
+        if (gst_buffer_map(buffer, &ms->map, GST_MAP_READ)) {
+            frame.image = QImage(static_cast<const uchar *>(ms->map.data), width, height, width * 4,
+                                 QImage::Format_RGB32, releaseMappedSample, ms);
+            return frame;
+        }
+        delete ms;
+        qDebug("failed to map received video buffer");
     } else {
         qDebug("wrong size of received buffer: %x != %lx", (width * height * 4), gst_buffer_get_size(buffer));
         gchar *capsstr;
@@ -24,28 +24,22 @@
 #include "rtpworker.h"
 #include <QPointer>
 
-// note: queuing frames doesn't really make much sense, since if the UI
-//   receives 5 frames at once, they'll just get painted on each other in
-//   succession and you'd only really see the last one.  however, we'll queue
-//   frames in case we ever want to do timestamped frames.
-#define QUEUE_FRAME_MAX 10
+// note: queuing frames doesn't make sense, since if the UI receives 5 frames
+//   at once, they'll just get painted on each other in succession and you'd
+//   only really see the last one.  worse, every queued frame pins a decoder
+//   buffer.  so at most one frame of each type is kept waiting, and a newer
+//   frame replaces it.
 
 namespace PsiMedia {
 
-static int queuedFrameInfo(const QList<RwControlMessage *> &list, RwControlFrame::Type type, int *firstPos)
+static int queuedFramePos(const QList<RwControlMessage *> &list, RwControlFrame::Type type)
 {
-    int  count = 0;
-    bool first = true;
     for (int n = 0; n < list.count(); ++n) {
         RwControlMessage *msg = list[n];
-        if (msg->type == RwControlMessage::Frame && static_cast<RwControlFrameMessage *>(msg)->frame.type == type) {
-            if (first)
-                *firstPos = n;
-            ++count;
-            first = false;
-        }
+        if (msg->type == RwControlMessage::Frame && static_cast<RwControlFrameMessage *>(msg)->frame.type == type)
+            return n;
     }
-    return count;
+    return -1;
 }
 
 static RwControlFrameMessage *getLatestFrameAndRemoveOthers(QList<RwControlMessage *> *list, RwControlFrame::Type type)
@@ -338,13 +332,12 @@ void RwControlLocal::postMessage(RwControlMessage *msg)
 {
     QMutexLocker locker(&in_mutex);
 
-    // if this is a frame, and the queue is maxed, then bump off the
-    //   oldest frame to make room
+    // if this is a frame, drop the stale one still waiting to be shown
     if (msg->type == RwControlMessage::Frame) {
-        auto fmsg     = static_cast<RwControlFrameMessage *>(msg);
-        int  firstPos = -1;
-        if (queuedFrameInfo(in, fmsg->frame.type, &firstPos) >= QUEUE_FRAME_MAX)
-            in.removeAt(firstPos);
+        auto fmsg = static_cast<RwControlFrameMessage *>(msg);
+        int  pos  = queuedFramePos(in, fmsg->frame.type);
+        if (pos != -1)
+            delete in.takeAt(pos);
     }
 
     in += msg;
@@ -133,6 +133,15 @@ public:
     inline PRtpPacket() : portOffset(0) { }
 };
 
+// queue counters of an RTP channel, for diagnosing a congested media path
+class PRtpChannelStats {
+public:
+    quint64 received   = 0; // packets pushed by the session
+    quint64 dropped    = 0; // packets bumped off a full queue
+    int     maxDepth   = 0; // deepest the pending queue got
+    qint64  maxLatency = 0; // longest push-to-delivery delay, in ms
+};
+
 class Provider : public QObjectInterface {
 public:
     virtual bool init()                = 0;
@@ -160,9 +169,10 @@ class RtpChannelContext : public QObjectInterface {
 public:
     virtual void setEnabled(bool b) = 0;
 
-    virtual int        packetsAvailable() const     = 0;
-    virtual PRtpPacket read()                       = 0;
-    virtual void       write(const PRtpPacket &rtp) = 0;
+    virtual int              packetsAvailable() const     = 0;
+    virtual PRtpPacket       read()                       = 0;
+    virtual void             write(const PRtpPacket &rtp) = 0;
+    virtual PRtpChannelStats stats() const                = 0;
 
     HINT_SIGNALS : HINT_METHOD(readyRead()) HINT_METHOD(packetsWritten(int count))
 };
@@ -275,7 +285,7 @@ public:
 Q_DECLARE_INTERFACE(PsiMedia::Plugin, "org.psi-im.psimedia.Plugin/1.5")
 Q_DECLARE_INTERFACE(PsiMedia::Provider, "org.psi-im.psimedia.Provider/1.5")
 Q_DECLARE_INTERFACE(PsiMedia::FeaturesContext, "org.psi-im.psimedia.FeaturesContext/1.4")
-Q_DECLARE_INTERFACE(PsiMedia::RtpChannelContext, "org.psi-im.psimedia.RtpChannelContext/1.4")
+Q_DECLARE_INTERFACE(PsiMedia::RtpChannelContext, "org.psi-im.psimedia.RtpChannelContext/1.6")
 Q_DECLARE_INTERFACE(PsiMedia::RtpSessionContext, "org.psi-im.psimedia.RtpSessionContext/1.5")
 Q_DECLARE_INTERFACE(PsiMedia::AudioRecorderContext, "org.psi-im.psimedia.AudioRecorderContext/1.4")
 
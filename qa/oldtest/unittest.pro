@@ -5,8 +5,14 @@ SUBDIRS += \
     ../src/tools/iconset/unittest \
     ../src/widgets/unittest/iconaction \
     ../src/widgets/unittest/richtext \
+    ../src/widgets/unittest/emojiregistry \
+    ../src/widgets/unittest/spellhighlighter \
     ../src/unittest/psiiconset \
-    ../src/unittest/psipopup
+    ../src/unittest/psipopup \
+    ../src/unittest/sxesession \
+    ../plugins/generic/omemoplugin/unittest \
+    ../src/unittest/httpconditional \
+    ../src/unittest/filesharing
 
 QMAKE_EXTRA_TARGETS += check
 check.commands = sh ./checkall
@@ -30,7 +30,6 @@
 #include "filecache.h"
 #include "iconset.h"
 #include "pepmanager.h"
-#include "pixmaputil.h"
 #include "profiles.h"
 #include "psiaccount.h"
 #include "vcardfactory.h"
@@ -48,10 +47,12 @@
 #include <QDomElement>
 #include <QFile>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QImageReader>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPixmap>
+#include <QtConcurrentRun>
 #include <QtCrypto>
 
 // we have retine nowdays and various other huge resolutions.96px is not that big already.
@@ -546,6 +547,8 @@ public:
 
     QQueue<std::tuple<Jid, QByteArray, bool>> vcardReqQueue_;
     QTimer                                    vcardReqTimer_;
+
+    QHash<QString, XMPP::Hash> decoding_; // bare jid -> avatar being decoded in background
 };
 
 AvatarFactory::AvatarFactory(PsiAccount *pa) : d(new Private)
@@ -598,21 +601,29 @@ AvatarFactory::~AvatarFactory() { delete d; }
 
 PsiAccount *AvatarFactory::account() const { return d->pa_; }
 
-inline static QPixmap ensureSquareAvatar(const QPixmap &original)
+// QImage is used here instead of QPixmap so it's safe to call from a worker thread
+static QImage ensureSquareAvatar(const QImage &original)
 {
     if (original.isNull() || original.width() == original.height())
         return original;
 
-    int     size   = qMax(original.width(), original.height());
-    QPixmap square = PixmapUtil::createTransparentPixmap(size, size);
+    int    size = qMax(original.width(), original.height());
+    QImage square(size, size, QImage::Format_ARGB32_Premultiplied);
+    square.fill(Qt::transparent);
 
     QPainter p(&square);
-    p.drawPixmap((size - original.width()) / 2, (size - original.height()) / 2, original);
+    p.drawImage((size - original.width()) / 2, (size - original.height()) / 2, original);
 
     return square;
 }
 
-QPixmap AvatarFactory::getAvatar(const Jid &_jid)
+/**
+ * \brief Returns square avatar of the contact
+ *
+ * If \a backgroundDecode is set and the avatar wasn't decoded yet, it's decoded in a worker
+ * thread, null pixmap is returned and avatarChanged() is emitted when the avatar is ready.
+ */
+QPixmap AvatarFactory::getAvatar(const Jid &_jid, bool backgroundDecode)
 {
     QString bareJid  = _jid.bare();
     QString iconName = QString("avatars/%1").arg(bareJid);
@@ -621,7 +632,15 @@ QPixmap AvatarFactory::getAvatar(const Jid &_jid)
         return iconp->pixmap();
     }
 
-    auto   icons = AvatarCache::instance()->icons(bareJid);
+    auto icons = AvatarCache::instance()->icons(bareJid);
+    if (backgroundDecode) {
+        FileCacheItem *item = icons.customAvatar ? icons.customAvatar : icons.avatar;
+        if (item) {
+            decodeAvatar(bareJid, item);
+            return QPixmap();
+        }
+    }
+
     QImage img;
     if (icons.customAvatar) {
         img = QImage::fromData(icons.customAvatar->data());
@@ -655,8 +674,7 @@ QPixmap AvatarFactory::getAvatar(const Jid &_jid)
         return QPixmap();
     }
 
-    QPixmap pm = QPixmap::fromImage(std::move(img));
-    pm         = ensureSquareAvatar(pm);
+    QPixmap pm = QPixmap::fromImage(ensureSquareAvatar(img));
 
     // Update iconset
     PsiIcon icon;
@@ -666,13 +684,41 @@ QPixmap AvatarFactory::getAvatar(const Jid &_jid)
     return pm;
 }
 
+void AvatarFactory::decodeAvatar(const QString &bareJid, FileCacheItem *item)
+{
+    if (d->decoding_.contains(bareJid))
+        return; // when finished it will check if the avatar is still the same
+
+    d->decoding_.insert(bareJid, item->id());
+    auto watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, bareJid]() {
+        QImage img = watcher->result();
+        watcher->deleteLater();
+
+        auto           hash  = d->decoding_.take(bareJid);
+        auto           icons = AvatarCache::instance()->icons(bareJid);
+        FileCacheItem *item  = icons.customAvatar ? icons.customAvatar : icons.avatar;
+        if (item && item->id() == hash && !img.isNull()) {
+            PsiIcon icon;
+            icon.setImpix(QPixmap::fromImage(std::move(img)));
+            d->iconset_.setIcon(QString("avatars/%1").arg(bareJid), icon);
+        } else if (item && item->id() == hash) {
+            getAvatar(Jid(bareJid)); // broken data. let the synchronous path clean it up
+        }
+        // if the avatar was changed meanwhile, the receivers will just request it again
+        emit avatarChanged(Jid(bareJid));
+    });
+    watcher->setFuture(QtConcurrent::run(
+        [](const QByteArray &data) { return ensureSquareAvatar(QImage::fromData(data)); }, item->data()));
+}
+
 #if 0
 QPixmap AvatarFactory::getAvatarByHash(const QString &hash)
 {
     FileCacheItem *item = AvatarCache::instance()->get(hash, true);
     if (item) {
         // ensureSquareAvatar may be unexpected in some cases. actually almost always and not only here
-        return ensureSquareAvatar(QPixmap::fromImage(std::move(QImage::fromData(item->data()))));
+        return QPixmap::fromImage(ensureSquareAvatar(QImage::fromData(item->data())));
     }
     return QPixmap();
 }
@@ -754,8 +800,7 @@ QPixmap AvatarFactory::getMucAvatar(const Jid &_jid)
         return QPixmap();
     }
 
-    QPixmap pm = QPixmap::fromImage(std::move(img));
-    pm         = ensureSquareAvatar(pm);
+    QPixmap pm = QPixmap::fromImage(ensureSquareAvatar(img));
 
     // Update iconset
     PsiIcon icon;
@@ -34,6 +34,7 @@
 
 class Avatar;
 class FileAvatar;
+class FileCacheItem;
 class PEPAvatar;
 class PsiAccount;
 class VCardAvatar;
@@ -69,7 +70,7 @@ public:
     AvatarFactory(PsiAccount *pa);
     ~AvatarFactory();
 
-    QPixmap getAvatar(const Jid &jid);
+    QPixmap getAvatar(const Jid &jid, bool backgroundDecode = false);
     // QPixmap getAvatarByHash(const QString& hash);
     static AvatarData avatarDataByHash(const QByteArray &hash);
     UserHashes        userHashes(const Jid &jid) const;
@@ -100,6 +101,8 @@ private slots:
     void vcardUpdated(const XMPP::Jid &, bool isMuc);
 
 private:
+    void decodeAvatar(const QString &bareJid, FileCacheItem *item);
+
     class Private;
     Private *d;
 };
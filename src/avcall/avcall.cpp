@@ -111,13 +111,27 @@ public:
 
     ~AvTransmit() override
     {
-        if (audio)
+        if (audio) {
+            logStats("audio", audio);
             audio->setParent(nullptr);
-        if (video)
+        }
+        if (video) {
+            logStats("video", video);
             video->setParent(nullptr);
+        }
         transport->setParent(nullptr);
     }
 
+private:
+    static void logStats(const char *name, const PsiMedia::RtpChannel *channel)
+    {
+        PsiMedia::RtpChannel::Stats s = channel->stats();
+        if (s.dropped)
+            qDebug("%s rtp channel: %llu of %llu packets dropped, max queue depth %d, max latency %lldms", name,
+                   static_cast<unsigned long long>(s.dropped), static_cast<unsigned long long>(s.received),
+                   s.maxDepth, static_cast<long long>(s.maxLatency));
+    }
+
 private slots:
     void audio_readyRead()
     {
@@ -27,6 +27,7 @@
 #include "psicontact.h"
 #include "userlist.h"
 
+#include <QCollator>
 #include <QCoreApplication>
 #include <QTextDocument>
 
@@ -158,21 +159,40 @@ ContactListItemMenu *ContactListItem::contextMenu()
 
 bool ContactListItem::isFixedSize() const { return true; }
 
+const ContactListItem::SortKey &ContactListItem::sortKey() const
+{
+    // accounts are never invalidated. there are just a few of them anyway
+    if (!_sortKey || _type == Type::AccountType) {
+        static QCollator collator; // roster is sorted in GUI thread only
+
+        int     rank = _type == Type::ContactType ? rankStatus(_contact->status().type()) : 0;
+        QString name = this->name().toLower();
+        _sortKey.emplace(SortKey { rank, name, collator.sortKey(name) });
+    }
+    return *_sortKey;
+}
+
+QString ContactListItem::sortName() const { return sortKey().name; }
+
+void ContactListItem::invalidateSortKey() { _sortKey.reset(); }
+
 bool ContactListItem::lessThan(const ContactListItem *other) const
 {
     if (_type == Type::GroupType && other->_type == Type::GroupType) {
         if (_specialGroupType != other->_specialGroupType) {
             return _specialGroupType < other->_specialGroupType;
         } else {
-            return QString::localeAwareCompare(_displayName.toLower(), other->_displayName.toLower()) < 0;
+            return sortKey().collationKey.compare(other->sortKey().collationKey) < 0;
         }
     } else if (_type == Type::ContactType && other->_type == Type::ContactType) {
-        int rank = rankStatus(_contact->status().type()) - rankStatus(other->_contact->status().type());
+        const SortKey &key      = sortKey();
+        const SortKey &otherKey = other->sortKey();
+        int            rank     = key.rank - otherKey.rank;
         if (rank == 0)
-            rank = QString::localeAwareCompare(_contact->name().toLower(), other->_contact->name().toLower());
+            rank = key.collationKey.compare(otherKey.collationKey);
         return rank < 0;
     } else if (_type == Type::AccountType && other->_type == Type::AccountType) {
-        return QString::localeAwareCompare(_account->name().toLower(), other->_account->name().toLower()) < 0;
+        return sortKey().collationKey.compare(other->sortKey().collationKey) < 0;
     } else if (_type == Type::ContactType && other->_type == Type::GroupType) {
         return _contact->isSelf();
     } else if (_type == Type::GroupType && other->_type == Type::ContactType) {
@@ -214,6 +234,7 @@ void ContactListItem::setName(const QString &name)
 
     case Type::GroupType:
         _displayName = name;
+        invalidateSortKey();
         break;
 
     default:
@@ -243,7 +264,11 @@ bool ContactListItem::editing() const { return _editing; }
 
 void ContactListItem::setEditing(bool editing) { _editing = editing; }
 
-void ContactListItem::setContact(PsiContact *contact) { _contact = contact; }
+void ContactListItem::setContact(PsiContact *contact)
+{
+    _contact = contact;
+    invalidateSortKey();
+}
 
 PsiContact *ContactListItem::contact() const { return _contact; }
 
@@ -460,7 +485,7 @@ QVariant ContactListItem::value(int role) const
                 if (_contact->isPrivate())
                     res = _contact->account()->avatarFactory()->getMucAvatar(_contact->jid());
                 else
-                    res = _contact->account()->avatarFactory()->getAvatar(_contact->jid());
+                    res = _contact->account()->avatarFactory()->getAvatar(_contact->jid(), true);
 
                 break;
 
@@ -21,11 +21,14 @@
 
 #include "abstracttreeitem.h"
 
+#include <QCollatorSortKey>
 #include <QObject>
 #include <QPointer>
 #include <QString>
 #include <QVariant>
 
+#include <optional>
+
 class ContactListItem;
 class ContactListItemMenu;
 class ContactListModel;
@@ -77,7 +80,10 @@ public:
 
     bool isFixedSize() const;
 
-    bool lessThan(const ContactListItem *other) const;
+    bool    lessThan(const ContactListItem *other) const;
+    QString sortName() const;
+    // has to be called when anything affecting sorting of the item is changed
+    void invalidateSortKey();
 
     bool editing() const;
     void setEditing(bool editing);
@@ -116,6 +122,13 @@ public:
     }
 
 private:
+    struct SortKey {
+        int              rank; // status rank for contacts
+        QString          name; // lower case name
+        QCollatorSortKey collationKey;
+    };
+    const SortKey &sortKey() const;
+
     ContactListModel *_model;
     Type              _type;
     SpecialGroupType  _specialGroupType;
@@ -130,6 +143,8 @@ private:
     mutable int          _onlineContacts;
     mutable bool         _shouldBeVisible;
     bool                 _hidden;
+
+    mutable std::optional<SortKey> _sortKey; // computed on first comparison
 };
 
 Q_DECLARE_METATYPE(ContactListItem *)
@@ -155,6 +155,9 @@ void ContactListModel::Private::updateContacts(const QList<PsiContact *> &contac
         indexes += indexes2;
 
         for (const QModelIndex &index : qAsConst(indexes2)) {
+            // status or name may be changed. proxy will resort the rows on dataChanged
+            q->toItem(index)->invalidateSortKey();
+
             QModelIndex parent = index.parent();
             int         row    = index.row();
             if (ranges.contains(parent)) {
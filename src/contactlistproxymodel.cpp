@@ -44,21 +44,26 @@ void ContactListProxyModel::setSourceModel(QAbstractItemModel *model)
     connect(model, SIGNAL(showTransportsChanged()), SLOT(filterParametersChanged()));
     connect(model, SIGNAL(showHiddenChanged()), SLOT(filterParametersChanged()));
     connect(model, SIGNAL(contactSortStyleChanged()), SLOT(updateSorting()));
+    updateFilterParameters();
+    updateSorting();
 }
 
-bool ContactListProxyModel::showOffline() const
+void ContactListProxyModel::updateFilterParameters()
 {
-    return qobject_cast<ContactListModel *>(sourceModel())->showOffline();
+    ContactListModel *model = qobject_cast<ContactListModel *>(sourceModel());
+    showOffline_            = model->showOffline();
+    showSelf_               = model->showSelf();
+    showTransports_         = model->showTransports();
+    showHidden_             = model->showHidden();
 }
 
-bool ContactListProxyModel::showSelf() const { return qobject_cast<ContactListModel *>(sourceModel())->showSelf(); }
+bool ContactListProxyModel::showOffline() const { return showOffline_; }
 
-bool ContactListProxyModel::showTransports() const
-{
-    return qobject_cast<ContactListModel *>(sourceModel())->showTransports();
-}
+bool ContactListProxyModel::showSelf() const { return showSelf_; }
+
+bool ContactListProxyModel::showTransports() const { return showTransports_; }
 
-bool ContactListProxyModel::showHidden() const { return qobject_cast<ContactListModel *>(sourceModel())->showHidden(); }
+bool ContactListProxyModel::showHidden() const { return showHidden_; }
 
 bool ContactListProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
@@ -147,23 +152,27 @@ bool ContactListProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &s
 
 bool ContactListProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
-    ContactListItem *item1 = qvariant_cast<ContactListItem *>(left.data(ContactListModel::ContactListItemRole));
-    ContactListItem *item2 = qvariant_cast<ContactListItem *>(right.data(ContactListModel::ContactListItemRole));
+    ContactListItem *item1 = static_cast<ContactListItem *>(left.internalPointer());
+    ContactListItem *item2 = static_cast<ContactListItem *>(right.internalPointer());
     if (!item1 || !item2)
         return false;
 
-    ContactListModel *model = qobject_cast<ContactListModel *>(sourceModel());
-    if (model->contactSortStyle() == "status" || !item1->isContact() || !item2->isContact()) {
+    if (sortByStatus_ || !item1->isContact() || !item2->isContact()) {
         return item1->lessThan(item2);
     } else {
-        return item1->name().toLower() < item2->name().toLower();
+        return item1->sortName() < item2->sortName();
     }
 }
 
 void ContactListProxyModel::filterParametersChanged()
 {
+    updateFilterParameters();
     invalidate();
     emit recalculateSize();
 }
 
-void ContactListProxyModel::updateSorting() { invalidate(); }
+void ContactListProxyModel::updateSorting()
+{
+    sortByStatus_ = qobject_cast<ContactListModel *>(sourceModel())->contactSortStyle() == "status";
+    invalidate();
+}
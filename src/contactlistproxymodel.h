@@ -48,6 +48,16 @@ protected:
 
 private slots:
     void filterParametersChanged();
+
+private:
+    void updateFilterParameters();
+
+    // cached model settings, so they are not queried for each row or comparison
+    bool showOffline_    = false;
+    bool showSelf_       = false;
+    bool showTransports_ = false;
+    bool showHidden_     = false;
+    bool sortByStatus_   = true;
 };
 
 #endif // CONTACTLISTPROXYMODEL_H
@@ -41,6 +41,7 @@
 
 #define ALERT_INTERVAL 100 /* msecs */
 #define ANIM_INTERVAL 300  /* msecs */
+#define AVATAR_CACHE_SIZE 8192 /* KiB */
 
 #define PSI_HIDPI computeScaleFactor(contactList)
 //#define PSI_HIDPI (2) // for testing purposes
@@ -130,6 +131,8 @@ ContactListViewDelegate::Private::Private(ContactListViewDelegate *parent, Conta
     animTimer->setSingleShot(false);
     connect(animTimer, SIGNAL(timeout()), SLOT(updateAnim()));
 
+    avatarCache_.setMaxCost(AVATAR_CACHE_SIZE);
+
     connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString &)), SLOT(optionChanged(const QString &)));
     connect(ColorOpt::instance(), SIGNAL(changed(const QString &)), SLOT(colorOptionChanged(const QString &)));
     connect(PsiIconset::instance(), SIGNAL(rosterIconsSizeChanged(int)), SLOT(rosterIconsSizeChanged(int)));
@@ -498,7 +501,16 @@ QPixmap ContactListViewDelegate::Private::avatarIcon(const QModelIndex &index)
     if (av.isNull() && useDefaultAvatar_)
         av = IconsetFactory::iconPixmap("psi/default_avatar", avSize);
 
-    return AvatarFactory::roundedAvatar(av, avatarRadius_, avSize);
+    if (av.isNull() || !avSize)
+        return QPixmap();
+
+    const QPair<qint64, int> key(av.cacheKey(), avSize << 16 | avatarRadius_);
+    if (auto cached = avatarCache_.object(key))
+        return *cached;
+
+    QPixmap rounded = AvatarFactory::roundedAvatar(av, avatarRadius_, avSize);
+    avatarCache_.insert(key, new QPixmap(rounded), qMax(1, rounded.width() * rounded.height() * 4 / 1024));
+    return rounded;
 }
 
 QPixmap ContactListViewDelegate::Private::rosterIndicator(const QString iconName)
@@ -3,6 +3,7 @@
 #include "contactlistview.h"
 #include "contactlistviewdelegate.h"
 
+#include <QCache>
 #include <QColor>
 #include <QFont>
 #include <QFontMetrics>
@@ -90,6 +91,9 @@ public:
     mutable QSet<QPersistentModelIndex> alertingIndexes;
     mutable QSet<QPersistentModelIndex> animIndexes;
 
+    // scaled and rounded avatars. (QPixmap::cacheKey, size << 16 | radius) -> pixmap. cost is in KiB
+    QCache<QPair<qint64, int>, QPixmap> avatarCache_;
+
     // Colors
     QColor _awayColor;
     QColor _dndColor;
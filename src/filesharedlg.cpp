@@ -70,6 +70,17 @@ FileShareDlg::FileShareDlg(PsiAccount *acc, const XMPP::Jid &myJid, const QList<
             tr->setState(MultiFileTransferModel::Done);
         }
         tr->setProperty("publisher", QVariant::fromValue<FileSharingItem *>(pi));
+        if (pi->isHashing()) {
+            tr->setInfo(FileShareDlg::tr("Calculating checksum"));
+            connect(pi, &FileSharingItem::hashingProgress, tr, [tr](int percent) {
+                tr->setInfo(FileShareDlg::tr("Calculating checksum: %1%").arg(percent));
+            });
+            connect(pi, &FileSharingItem::hashingFinished, tr, [pi, tr]() {
+                if (pi->sums().isEmpty()) // the file became unreadable after it was added
+                    tr->setState(MultiFileTransferModel::Failed, FileShareDlg::tr("Failed to read the file"));
+                tr->setInfo(QString());
+            });
+        }
     }
 
     QImage preview;
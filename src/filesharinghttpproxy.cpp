@@ -21,6 +21,7 @@
 #include "filecache.h"
 #include "filesharingitem.h"
 #include "filesharingmanager.h"
+#include "httpconditional.h"
 #include "psiaccount.h"
 #include "psicon.h"
 #include "qhttpserverconnection.hpp"
@@ -28,11 +29,13 @@
 #include "qhttpserverresponse.hpp"
 #include "webserver.h"
 
+#include <QFile>
+#include <QFileInfo>
 #include <QTcpSocket>
 #include <cinttypes>
 #include <tuple>
 
-#define HTTP_CHUNK (512 * 1024 * 1024)
+#define HTTP_CHUNK (512 * 1024) /* bytes */
 
 FileSharingHttpProxy::FileSharingHttpProxy(PsiAccount *acc, const QString &sourceIdHex,
                                            qhttp::server::QHttpRequest *req, qhttp::server::QHttpResponse *res) :
@@ -45,19 +48,33 @@ FileSharingHttpProxy::FileSharingHttpProxy(PsiAccount *acc, const QString &sourc
            qPrintable(req->url().toString()), qPrintable(req->headers().value("range")));
 
     if (!item) {
-        res->setStatusCode(qhttp::ESTATUS_NOT_FOUND);
-        emit req->end();
+        finish(qhttp::ESTATUS_NOT_FOUND);
+        return;
+    }
+
+    if (!item->sums().isEmpty())
+        entityTag = '"' + item->sums().first().toHex() + '"';
+
+    // the content behind a hash never changes, so a matching tag needs neither cache nor download
+    if (isNotModified(QDateTime())) {
+        finish(qhttp::ESTATUS_NOT_MODIFIED);
         return;
     }
 
     auto status = qhttp::TStatusCode(parseHttpRangeRequest());
     if (status != qhttp::ESTATUS_OK) {
-        res->setStatusCode(status);
         qWarning("http range parse failed: %d", status);
-        emit req->end();
+        finish(status);
         return; // handled with error
     }
 
+    // If-Range with another tag or a date means the client's copy may be stale, so send everything
+    if (isRanged && !HttpConditional::isRangeValid(request->headers().value("if-range"), entityTag)) {
+        isRanged       = false;
+        requestedStart = 0;
+        requestedSize  = 0;
+    }
+
     if (isRanged && item->isSizeKnown()) {
         if (requestedStart == 0 && requestedSize == item->fileSize())
             isRanged = false;
@@ -88,6 +105,35 @@ FileSharingHttpProxy::FileSharingHttpProxy(PsiAccount *acc, const QString &sourc
 
 FileSharingHttpProxy::~FileSharingHttpProxy() { qDebug("FSP deleted"); }
 
+bool FileSharingHttpProxy::isNotModified(const QDateTime &lastModified) const
+{
+    const auto &headers = request->headers();
+    return HttpConditional::isNotModified(headers.value("if-none-match"), headers.value("if-modified-since"),
+                                          entityTag, lastModified);
+}
+
+bool FileSharingHttpProxy::isKeepAlive() const
+{
+    const auto &headers = request->headers();
+    if (request->httpVersion() == QLatin1String("1.0"))
+        return headers.keyHasValue("connection", "keep-alive");
+    return !headers.keyHasValue("connection", "close");
+}
+
+// ends the response without a body, keeping the connection open for the next request when possible
+void FileSharingHttpProxy::finish(int status)
+{
+    response->setStatusCode(qhttp::TStatusCode(status));
+    if (status == qhttp::ESTATUS_NOT_MODIFIED && !entityTag.isEmpty())
+        response->addHeader("ETag", entityTag);
+    if (isKeepAlive()) {
+        if (status != qhttp::ESTATUS_NOT_MODIFIED)
+            response->addHeader("Content-Length", "0");
+        response->addHeader("Connection", "keep-alive");
+    }
+    response->end();
+}
+
 // returns <parsed,list of start/size>
 int FileSharingHttpProxy::parseHttpRangeRequest()
 {
@@ -153,11 +199,13 @@ void FileSharingHttpProxy::setupHeaders(qint64 fileSize, QString contentType, QD
                                         qint64 rangeStart, qint64 rangeSize)
 {
     if (lastModified.isValid())
-        response->addHeader("Last-Modified", lastModified.toString(Qt::RFC2822Date).toLatin1());
+        response->addHeader("Last-Modified", HttpConditional::formatDate(lastModified));
+    if (!entityTag.isEmpty())
+        response->addHeader("ETag", entityTag);
     if (contentType.count())
         response->addHeader("Content-Type", contentType.toLatin1());
 
-    bool keepAlive = true;
+    bool keepAlive = isKeepAlive();
     response->addHeader("Accept-Ranges", "bytes");
     if (isRanged) {
         response->setStatusCode(qhttp::ESTATUS_PARTIAL_CONTENT);
@@ -181,44 +229,69 @@ void FileSharingHttpProxy::setupHeaders(qint64 fileSize, QString contentType, QD
 
 void FileSharingHttpProxy::proxyCache()
 {
-    auto status = qhttp::TStatusCode(parseHttpRangeRequest());
-    if (status != qhttp::ESTATUS_OK) {
-        response->setStatusCode(status);
-        qWarning("http range parse failed: %d", status);
-        emit request->end();
+    cacheFile = new QFile(item->fileName(), this);
+    QFileInfo fi(*cacheFile);
+    if (!cacheFile->open(QIODevice::ReadOnly)) {
+        qWarning("FSP failed to open cached file: %s", qPrintable(cacheFile->errorString()));
+        finish(qhttp::ESTATUS_NOT_FOUND);
         return; // handled with error
     }
-    QFile *   file = new QFile(item->fileName(), response);
-    QFileInfo fi(*file);
-    if (!file->open(QIODevice::ReadOnly)) {
-        response->setStatusCode(qhttp::ESTATUS_NOT_FOUND);
-        qWarning("FSP failed to open cached file: %s", qPrintable(file->errorString()));
-        emit request->end();
-        return; // handled with error
+    if (isNotModified(fi.lastModified())) {
+        finish(qhttp::ESTATUS_NOT_MODIFIED);
+        return;
     }
+
     qint64 size = fi.size();
     if (isRanged) {
         if (requestedSize)
             size = (requestedStart + requestedSize) > fi.size() ? fi.size() - requestedStart : requestedSize;
         else // remaining part
             size = fi.size() - requestedStart;
-        file->seek(requestedStart);
     }
-    // TODO If-Modified-Since
     setupHeaders(fi.size(), item->mimeType(), fi.lastModified(), isRanged, requestedStart, size);
-    connect(response, &qhttp::server::QHttpResponse::allBytesWritten, file, [this, file, size]() {
-        qint64 toWrite = requestedStart + size - file->pos();
-        if (!toWrite) {
+    headersSent = true;
+
+    cachePos = isRanged ? requestedStart : 0;
+    cacheEnd = cachePos + size;
+    auto status = isRanged ? qhttp::ESTATUS_PARTIAL_CONTENT : qhttp::ESTATUS_OK;
+    if (size && HttpConditional::hasBody(request->methodString(), status)) {
+        // the socket copies what we write anyway, so hand it the page cache instead of a read buffer
+        cacheMap = cacheFile->map(cachePos, size);
+        if (!cacheMap)
+            cacheFile->seek(cachePos);
+        connect(response, &qhttp::server::QHttpResponse::allBytesWritten, this, &FileSharingHttpProxy::transferCache);
+        transferCache();
+    } else {
+        response->end();
+    }
+}
+
+void FileSharingHttpProxy::transferCache()
+{
+    qint64 toWrite = qMin(cacheEnd - cachePos, qint64(HTTP_CHUNK));
+    if (toWrite <= 0)
+        return;
+
+    QByteArray data;
+    if (cacheMap) {
+        data = QByteArray::fromRawData(reinterpret_cast<const char *>(cacheMap), int(toWrite));
+        cacheMap += toWrite;
+    } else {
+        data = cacheFile->read(toWrite);
+        if (data.isEmpty()) {
+            qWarning("FSP failed to read cached file: %s", qPrintable(cacheFile->errorString()));
+            response->connection()->killConnection();
             return;
         }
-        if (toWrite > HTTP_CHUNK)
-            response->write(file->read(HTTP_CHUNK));
-        else
-            response->end(file->read(toWrite));
-    });
-
-    if (size < HTTP_CHUNK) {
-        response->end(file->read(size));
+    }
+    cachePos += data.size();
+    if (cachePos < cacheEnd)
+        response->write(data); // the next chunk waits for allBytesWritten, so the mapping outlives it
+    else {
+        // the socket may still hold the last chunk when we and the mapping are gone
+        if (cacheMap)
+            data = QByteArray(data.constData(), data.size());
+        response->end(data);
     }
 }
 
@@ -262,6 +335,16 @@ void FileSharingHttpProxy::onMetadataChanged()
                  start, size);
     headersSent = true;
 
+    // HEAD gets the headers the download would have produced and nothing else
+    auto status = downloader->isRanged() ? qhttp::ESTATUS_PARTIAL_CONTENT : qhttp::ESTATUS_OK;
+    if (!HttpConditional::hasBody(request->methodString(), status)) {
+        downloader->disconnect(this);
+        downloader->deleteLater();
+        downloader = nullptr;
+        response->end();
+        return;
+    }
+
     connect(downloader, &FileShareDownloader::readyRead, this, &FileSharingHttpProxy::transfer);
     connect(downloader, &FileShareDownloader::disconnected, this, &FileSharingHttpProxy::transfer);
     connect(response, &qhttp::server::QHttpResponse::allBytesWritten, this, &FileSharingHttpProxy::transfer);
@@ -20,9 +20,13 @@
 #ifndef FILESHARINGHTTPPROXY_H
 #define FILESHARINGHTTPPROXY_H
 
+#include <QByteArray>
+#include <QDateTime>
 #include <QObject>
 #include <QPointer>
 
+class QFile;
+
 class FileCacheItem;
 class FileSharingItem;
 class FileShareDownloader;
@@ -46,9 +50,13 @@ public slots:
 private slots:
     void onMetadataChanged();
     void transfer();
+    void transferCache();
 
 private:
     int  parseHttpRangeRequest();
+    bool isNotModified(const QDateTime &lastModified) const;
+    bool isKeepAlive() const;
+    void finish(int status);
     void setupHeaders(qint64 fileSize, QString contentType, QDateTime lastModified, bool isRanged, qint64 rangeStart,
                       qint64 rangeSize);
     void proxyCache();
@@ -59,6 +67,11 @@ private:
     qhttp::server::QHttpRequest * request;
     qhttp::server::QHttpResponse *response;
     QPointer<FileShareDownloader> downloader;
+    QByteArray                    entityTag; // strong ETag from the content hash, if known
+    QFile *                       cacheFile      = nullptr;
+    const uchar *                 cacheMap       = nullptr; // cacheFile mapped at cachePos, if possible
+    qint64                        cachePos       = 0;
+    qint64                        cacheEnd       = 0;
     qint64                        requestedStart = 0;
     qint64                        requestedSize  = 0;  // if == 0 then all the remaining
     qint64                        bytesLeft      = -1; // -1 - unknown
@@ -32,16 +32,56 @@
 #include <QCryptographicHash>
 #include <QDir>
 #include <QFileIconProvider>
+#include <QFutureWatcher>
 #include <QImageReader>
 #include <QMimeDatabase>
 #include <QPainter>
 #include <QTemporaryFile>
+#include <QtConcurrentRun>
 
 #define TEMP_TTL (7 * 24 * 3600)
 #define FILE_TTL (365 * 24 * 3600)
+#define HASH_CHUNK (1024 * 1024) /* bytes */
 
 using namespace XMPP;
 
+struct FileSharingItem::HashingResult {
+    Hash    hash;
+    QString mimeType;
+};
+
+// runs in a worker thread
+void FileSharingItem::hashFile(QFutureInterface<HashingResult> fi, const QString &fileName)
+{
+    HashingResult result;
+    QFile         file(fileName);
+    if (file.open(QIODevice::ReadOnly)) {
+        StreamHash hasher(Hash::Sha1);
+        QByteArray buf;
+        qint64     total = file.size();
+        qint64     done  = 0;
+        while (!fi.isCanceled()) {
+            buf.resize(HASH_CHUNK);
+            auto bytes = file.read(buf.data(), buf.size());
+            if (bytes <= 0)
+                break;
+            buf.resize(int(bytes));
+            if (!hasher.addData(buf))
+                break;
+            done += bytes;
+            if (total)
+                fi.setProgressValue(int(done * 100 / total));
+        }
+        if (!fi.isCanceled() && done == total) {
+            result.hash = hasher.final();
+            file.seek(0);
+            result.mimeType = QMimeDatabase().mimeTypeForFileNameAndData(fileName, &file).name();
+        }
+    }
+    fi.reportResult(result);
+    fi.reportFinished();
+}
+
 // ======================================================================
 // FileSharingItem
 // ======================================================================
@@ -111,21 +151,11 @@ FileSharingItem::FileSharingItem(const QString &fileName, PsiAccount *acc, FileS
     QObject(manager), _acc(acc), _manager(manager), _fileType(FileType::LocalLink), _flags(SizeKnown),
     _fileName(fileName)
 {
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly))
-        return;
-
-    auto h = Hash::from(Hash::Sha1, &file);
-    if (!h.isValid())
-        return;
-
-    _sums.append(h);
-
-    if (!initFromCache()) {
-        file.seek(0);
-        _fileSize = quint64(file.size());
-        _mimeType = QMimeDatabase().mimeTypeForFileNameAndData(fileName, &file).name();
-    }
+    // the content based values will be refined when hashing is finished
+    QFileInfo fi(fileName);
+    _fileSize = quint64(fi.size());
+    _mimeType = QMimeDatabase().mimeTypeForFile(fi, QMimeDatabase::MatchExtension).name();
+    startHashing();
 }
 
 FileSharingItem::FileSharingItem(const QString &mime, const QByteArray &data, const QVariantMap &metaData,
@@ -154,6 +184,8 @@ FileSharingItem::FileSharingItem(const QString &mime, const QByteArray &data, co
 
 FileSharingItem::~FileSharingItem()
 {
+    if (_hashing)
+        _hashing->cancel();
     if (_fileType == FileType::TempFile && !_fileName.isEmpty()) {
         QFile f(_fileName);
         if (f.exists())
@@ -161,6 +193,37 @@ FileSharingItem::~FileSharingItem()
     }
 }
 
+void FileSharingItem::startHashing()
+{
+    QFutureInterface<HashingResult> fi;
+    fi.setProgressRange(0, 100);
+    fi.reportStarted();
+
+    _hashing = new QFutureWatcher<HashingResult>(this);
+    connect(_hashing, &QFutureWatcherBase::progressValueChanged, this, &FileSharingItem::hashingProgress);
+    connect(_hashing, &QFutureWatcherBase::finished, this, &FileSharingItem::hashingDone);
+    _hashing->setFuture(fi.future());
+
+    QtConcurrent::run([fi, fileName = _fileName]() { hashFile(fi, fileName); });
+}
+
+void FileSharingItem::hashingDone()
+{
+    auto result = _hashing->result();
+    _hashing->deleteLater();
+    _hashing = nullptr;
+
+    if (result.hash.isValid()) {
+        _sums.append(result.hash);
+        if (!initFromCache())
+            _mimeType = result.mimeType;
+    } else {
+        _log.append(tr("Failed to read the file"));
+        emit logChanged();
+    }
+    emit hashingFinished();
+}
+
 bool FileSharingItem::initFromCache(FileCacheItem *cache)
 {
     if (!cache && _sums.size())
@@ -260,10 +323,18 @@ QIcon FileSharingItem::thumbnail(const QSize &size) const
     if (_fileType == FileType::RemoteFile)
         return QIcon();
 
-    QImage image;
-    if (_mimeType.startsWith(QLatin1String("image")) && image.load(_fileName)) {
-        auto   img = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        QImage back(64, 64, QImage::Format_ARGB32_Premultiplied);
+    QImage img;
+    if (_mimeType.startsWith(QLatin1String("image"))) {
+        if (_sums.size())
+            img = _manager->cachedThumbnail(_sums.first(), size);
+        if (img.isNull()) {
+            img = decodeImage(size, true);
+            if (!img.isNull() && _sums.size())
+                _manager->cacheThumbnail(_sums.first(), size, img);
+        }
+    }
+    if (!img.isNull()) {
+        QImage back(size, QImage::Format_ARGB32_Premultiplied);
         back.fill(Qt::transparent);
         QPainter painter(&back);
         auto     imgRect = img.rect();
@@ -274,14 +345,28 @@ QIcon FileSharingItem::thumbnail(const QSize &size) const
     return QFileIconProvider().icon(_fileName);
 }
 
-QImage FileSharingItem::preview(const QSize &maxSize) const
+QImage FileSharingItem::preview(const QSize &maxSize) const { return decodeImage(maxSize, false); }
+
+// Decodes the image right at the requested size. For jpeg it's much cheaper than
+// loading the full image and scaling it afterwards.
+QImage FileSharingItem::decodeImage(const QSize &size, bool enlarge) const
 {
-    QImage image;
-    if (image.load(_fileName)) {
-        auto s = image.size().boundedTo(maxSize);
-        return image.scaled(s, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    QImageReader reader(_fileName);
+    reader.setAutoTransform(true);
+    auto imageSize = reader.size();
+    if (imageSize.isValid()) {
+        // the scaled size is applied before the orientation transform
+        bool rotated = reader.transformation() & QImageIOHandler::TransformationRotate90;
+        if (rotated)
+            imageSize.transpose();
+        if (enlarge || imageSize.width() > size.width() || imageSize.height() > size.height()) {
+            auto scaledSize = imageSize.scaled(size, Qt::KeepAspectRatio);
+            if (rotated)
+                scaledSize.transpose();
+            reader.setScaledSize(scaledSize);
+        }
     }
-    return image;
+    return reader.read();
 }
 
 QString FileSharingItem::displayName() const
@@ -307,9 +392,23 @@ FileCacheItem *FileSharingItem::cache(bool reborn) const
 
 void FileSharingItem::publish(const XMPP::Jid &myJid)
 {
-    Q_UNUSED(myJid)
     Q_ASSERT(_fileType != FileType::RemoteFile);
 
+    if (_hashing) { // we need the hash to put the file to the cache
+        if (!(_flags & PublishPending)) {
+            _flags |= PublishPending;
+            connect(this, &FileSharingItem::hashingFinished, this, [this, myJid]() {
+                _flags &= ~PublishPending;
+                publish(myJid);
+            });
+        }
+        return;
+    }
+    if (_sums.isEmpty()) {
+        emit publishFinished();
+        return;
+    }
+
     if (_flags & PublishNotified) {
         emit publishFinished();
         return;
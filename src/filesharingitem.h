@@ -30,6 +30,9 @@ class FileShareDownloader;
 class FileSharingManager;
 class PsiAccount;
 
+template <typename T> class QFutureInterface;
+template <typename T> class QFutureWatcher;
+
 namespace XMPP {
 class Jid;
 class MediaSharing;
@@ -60,6 +63,7 @@ public:
         JingleFinished  = 0x2,
         PublishNotified = 0x4,
         SizeKnown       = 0x8,
+        PublishPending  = 0x10, // publish() waits for hashing
     };
     Q_DECLARE_FLAGS(Flags, Flag)
 
@@ -83,6 +87,8 @@ public:
     inline quint64            fileSize() const { return _fileSize; }
     inline bool               isSizeKnown() const { return bool(_flags & SizeKnown); }
     inline const QStringList &uris() const { return _uris; }
+    // local files are hashed in background. sums() is empty until it's finished
+    inline bool isHashing() const { return _hashing != nullptr; }
 
     // reborn flag updates ttl for the item
     FileCacheItem *          cache(bool reborn = false) const;
@@ -112,9 +118,18 @@ public:
     QUrl simpleSource() const;
 
 private:
-    bool initFromCache(FileCacheItem *cache = nullptr);
+    struct HashingResult;
+
+    bool   initFromCache(FileCacheItem *cache = nullptr);
+    void   startHashing();
+    void   hashingDone();
+    QImage decodeImage(const QSize &size, bool enlarge) const;
+
+    static void hashFile(QFutureInterface<HashingResult> fi, const QString &fileName);
 
 signals:
+    void hashingProgress(int percent);
+    void hashingFinished();
     void publishFinished();
     void publishProgress(size_t transferredBytes);
     void downloadFinished();
@@ -136,6 +151,8 @@ private:
     QVariantMap          _metaData;
     QStringList          _log;
     QList<XMPP::Jid>     _jids;
+
+    QFutureWatcher<HashingResult> *_hashing = nullptr;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(FileSharingItem::Flags)
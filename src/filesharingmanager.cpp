@@ -45,9 +45,13 @@
 #include "messageview.h"
 #include "textutil.h"
 
+#include <QBuffer>
 #include <QDir>
+#include <QImage>
 #include <QMimeData>
 
+#define THUMBNAIL_TTL (30 * 24 * 3600)
+
 // ======================================================================
 // FileSharingManager
 // ======================================================================
@@ -58,6 +62,13 @@ public:
 
     void rememberItem(FileSharingItem *item)
     {
+        if (item->isHashing()) { // the item can be looked up only by its content hash
+            QObject::connect(item, &FileSharingItem::hashingFinished, item, [this, item]() {
+                if (item->sums().size())
+                    rememberItem(item);
+            });
+            return;
+        }
         Q_ASSERT(item->sums().size());
         for (auto const &v : item->sums())
             items.insert(v, item); // TODO ensure we don't overwrite
@@ -120,6 +131,31 @@ FileCacheItem *FileSharingManager::moveToCache(const QList<XMPP::Hash> &sums, co
     return d->cache->moveToCache(sums, file, metadata, maxAge);
 }
 
+Hash FileSharingManager::thumbnailId(const Hash &sourceId, const QSize &size)
+{
+    auto key = QString("%1/thumb/%2x%3").arg(sourceId.toString()).arg(size.width()).arg(size.height());
+    return Hash::from(Hash::Sha1, key.toLatin1());
+}
+
+QImage FileSharingManager::cachedThumbnail(const XMPP::Hash &sourceId, const QSize &size)
+{
+    auto data = d->cache->getData(thumbnailId(sourceId, size), true);
+    return data.isEmpty() ? QImage() : QImage::fromData(data, "PNG");
+}
+
+void FileSharingManager::cacheThumbnail(const XMPP::Hash &sourceId, const QSize &size, const QImage &thumbnail)
+{
+    QByteArray data;
+    QBuffer    buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!thumbnail.save(&buffer, "PNG"))
+        return;
+
+    QVariantMap vm;
+    vm.insert(QString::fromLatin1("type"), QString::fromLatin1("image/png"));
+    d->cache->append(thumbnailId(sourceId, size), data, vm, THUMBNAIL_TTL);
+}
+
 FileSharingItem *FileSharingManager::item(const Hash &id) { return d->items.value(id); }
 
 QList<FileSharingItem *> FileSharingManager::fromMimeData(const QMimeData *data, PsiAccount *acc)
@@ -151,6 +187,7 @@ QList<FileSharingItem *> FileSharingManager::fromMimeData(const QMimeData *data,
                 continue;
             }
             QFileInfo fi(url.toLocalFile());
+            // unreadable files are dropped here, since hashing runs in background and fails only later
             if (fi.isFile() && fi.isReadable()) {
                 files.append(fi.filePath());
             }
@@ -179,8 +216,6 @@ QList<FileSharingItem *> FileSharingManager::fromMimeData(const QMimeData *data,
     } else {
         for (auto const &f : files) {
             auto item = new FileSharingItem(f, acc, this);
-            if (!item->sums().count())
-                continue; // failed to calculate checksum. permissions problem?
             d->rememberItem(item);
             ret.append(item);
         }
@@ -35,6 +35,7 @@ class PsiAccount;
 class QFileInfo;
 class QImage;
 class QMimeData;
+class QSize;
 
 namespace qhttp { namespace server {
     class QHttpRequest;
@@ -77,6 +78,11 @@ public:
     FileCacheItem *moveToCache(const QList<XMPP::Hash> &sums, const QFileInfo &data, const QVariantMap &metadata,
                                unsigned int maxAge);
 
+    // thumbnails of shared files, keyed by the source file hash and the thumbnail size
+    static XMPP::Hash thumbnailId(const XMPP::Hash &sourceId, const QSize &size);
+    QImage            cachedThumbnail(const XMPP::Hash &sourceId, const QSize &size);
+    void              cacheThumbnail(const XMPP::Hash &sourceId, const QSize &size, const QImage &thumbnail);
+
     FileSharingItem *item(const XMPP::Hash &id);
     // FileSharingItem* fromReference(const XMPP::Reference &ref, PsiAccount *acc);
     QList<FileSharingItem *> fromMimeData(const QMimeData *data, PsiAccount *acc);
@@ -402,11 +402,18 @@ void DisplayProxy::displayWithSearchCursor(const QString &acc_id, const Jid &jid
 
 bool DisplayProxy::isMessage(const QTextCursor &cursor) const
 {
-    int pos = cursor.positionInBlock();
-    if (pos > 22)                                                       // the timestamp length
-        if (cursor.block().text().leftRef(pos - 1).indexOf("> ") != -1) // skip nickname
-            return true;
-    return false;
+    int start = messageStart(cursor.block().text());
+    return start != -1 && cursor.selectionStart() - cursor.block().position() >= start;
+}
+
+/**
+ * Returns the position where the message text starts in a displayed line,
+ * i.e. past the timestamp and the nickname, or -1 if it's not a message line.
+ */
+int DisplayProxy::messageStart(const QString &blockText)
+{
+    int pos = blockText.indexOf(QLatin1String("> "), 22); // skip the timestamp and the nickname
+    return pos == -1 ? -1 : pos + 2;
 }
 
 void DisplayProxy::handleResult()
@@ -527,6 +534,9 @@ void DisplayProxy::displayResult(const EDBResult &r, int dir)
         Q_ASSERT(acc);
     }
 
+    // don't relayout and repaint the view after every single line
+    viewWid->setUpdatesEnabled(false);
+
     bool fAllContacts = jid_.isEmpty();
     while (i >= 0 && i < r.count()) {
         EDBItemPtr    item = r.value(i);
@@ -556,6 +566,7 @@ void DisplayProxy::displayResult(const EDBResult &r, int dir)
         }
         i += d;
     }
+    viewWid->setUpdatesEnabled(true);
     viewWid->verticalScrollBar()->setValue(viewWid->verticalScrollBar()->maximum());
     emit updated();
 }
@@ -861,33 +872,31 @@ void HistoryDlg::openSelectedContact()
 
 void HistoryDlg::highlightBlocks()
 {
-    const QString text   = ui_.searchField->text();
-    QTextCursor   cur    = ui_.msgLog->textCursor();
-    QTextCursor   old    = cur;
-    int           sc_pos = 0;
-    if (ui_.msgLog->verticalScrollBar())
-        sc_pos = ui_.msgLog->verticalScrollBar()->value();
-    cur.clearSelection();
-    cur.movePosition(QTextCursor::Start);
-    ui_.msgLog->setTextCursor(cur);
-
+    // search the document's lines directly. going through QTextEdit::find()
+    //   would move the view's cursor and scroll for every single hit
+    const QString                    text = ui_.searchField->text();
     QList<QTextEdit::ExtraSelection> extras;
-    QTextEdit::ExtraSelection        highlight;
-    highlight.format.setBackground(Qt::yellow);
-    highlight.cursor = ui_.msgLog->textCursor();
-
-    bool found = ui_.msgLog->find(text);
-    while (found) {
-        highlight.cursor = ui_.msgLog->textCursor();
-        if (displayProxy->isMessage(highlight.cursor))
-            extras << highlight;
-        found = ui_.msgLog->find(text);
+    if (!text.isEmpty()) {
+        QTextEdit::ExtraSelection highlight;
+        highlight.format.setBackground(Qt::yellow);
+
+        QTextDocument *doc = ui_.msgLog->document();
+        for (QTextBlock block = doc->begin(); block.isValid(); block = block.next()) {
+            const QString line = block.text();
+            int           pos  = DisplayProxy::messageStart(line);
+            if (pos == -1)
+                continue;
+            while ((pos = line.indexOf(text, pos, Qt::CaseInsensitive)) != -1) {
+                highlight.cursor = QTextCursor(doc);
+                highlight.cursor.setPosition(block.position() + pos);
+                highlight.cursor.setPosition(block.position() + pos + text.size(), QTextCursor::KeepAnchor);
+                extras << highlight;
+                pos += text.size();
+            }
+        }
     }
 
     ui_.msgLog->setExtraSelections(extras);
-    ui_.msgLog->setTextCursor(old);
-    if (ui_.msgLog->verticalScrollBar())
-        ui_.msgLog->verticalScrollBar()->setValue(sc_pos);
 }
 
 void HistoryDlg::findMessages()
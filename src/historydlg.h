@@ -102,6 +102,8 @@ public:
                                  const QString &s_str, int num);
     bool isMessage(const QTextCursor &cursor) const;
 
+    static int messageStart(const QString &blockText);
+
 private slots:
     void handleResult();
 
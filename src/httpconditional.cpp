@@ -0,0 +1,81 @@
+/*
+ * httpconditional.cpp - conditional HTTP request helpers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "httpconditional.h"
+
+#include <QList>
+#include <QLocale>
+
+namespace HttpConditional {
+
+// qhttp lower-cases header values, while RFC 2822 parsing wants "Sun, 06 Nov 1994"
+QDateTime parseDate(const QByteArray &value)
+{
+    QString s         = QString::fromLatin1(value).trimmed();
+    bool    wordStart = true;
+    for (QChar &c : s) {
+        if (c.isLetter()) {
+            if (wordStart)
+                c = c.toUpper();
+            wordStart = false;
+        } else
+            wordStart = true;
+    }
+    return QDateTime::fromString(s, Qt::RFC2822Date);
+}
+
+QByteArray formatDate(const QDateTime &dt)
+{
+    return QLocale::c().toString(dt.toUTC(), QLatin1String("ddd, dd MMM yyyy hh:mm:ss 'GMT'")).toLatin1();
+}
+
+bool isNotModified(const QByteArray &ifNoneMatch, const QByteArray &ifModifiedSince, const QByteArray &entityTag,
+                   const QDateTime &lastModified)
+{
+    if (!ifNoneMatch.isEmpty()) {
+        if (entityTag.isEmpty())
+            return false;
+        const auto tags = ifNoneMatch.split(',');
+        for (const auto &tag : tags) {
+            auto t = tag.trimmed();
+            if (t.startsWith("w/")) // weak comparison is fine for GET
+                t = t.mid(2);
+            if (t == "*" || t == entityTag)
+                return true;
+        }
+        return false; // If-Modified-Since is ignored when If-None-Match is present
+    }
+
+    if (ifModifiedSince.isEmpty() || !lastModified.isValid())
+        return false;
+    auto since = parseDate(ifModifiedSince);
+    return since.isValid() && lastModified.toSecsSinceEpoch() <= since.toSecsSinceEpoch();
+}
+
+bool isRangeValid(const QByteArray &ifRange, const QByteArray &entityTag)
+{
+    // a date or another tag means the client's copy may be stale. only strong tags are usable here
+    return ifRange.isEmpty() || (!entityTag.isEmpty() && ifRange.trimmed() == entityTag);
+}
+
+bool hasBody(const QString &method, int status) {
+    return method.compare(QLatin1String("HEAD"), Qt::CaseInsensitive) != 0 && status >= 200 && status != 204
+        && status != 304;
+}
+
+} // namespace HttpConditional
@@ -0,0 +1,44 @@
+/*
+ * httpconditional.h - conditional HTTP request helpers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef HTTPCONDITIONAL_H
+#define HTTPCONDITIONAL_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+
+// Header values are expected lower-cased, the way qhttp delivers them.
+namespace HttpConditional {
+
+QDateTime  parseDate(const QByteArray &value);
+QByteArray formatDate(const QDateTime &dt);
+
+// If-None-Match / If-Modified-Since: true if 304 Not Modified is the answer
+bool isNotModified(const QByteArray &ifNoneMatch, const QByteArray &ifModifiedSince, const QByteArray &entityTag,
+                   const QDateTime &lastModified);
+
+// If-Range: false if the client's copy may be stale and the whole entity has to be sent instead of the range
+bool isRangeValid(const QByteArray &ifRange, const QByteArray &entityTag);
+
+// HEAD requests and some statuses never carry a body
+bool hasBody(const QString &method, int status);
+
+} // namespace HttpConditional
+
+#endif // HTTPCONDITIONAL_H
@@ -94,6 +94,7 @@ bool ASpellChecker::add(const QString &word)
             aspell_speller_add_to_personal(spellers_.first(), trimmed_word.toUtf8(), trimmed_word.toUtf8().length());
             aspell_speller_save_all_word_lists(spellers_.first());
             result = true;
+            invalidate();
         }
     }
     return result;
@@ -129,6 +130,7 @@ QSet<LanguageManager::LangId> ASpellChecker::getAllLanguages() const
 void ASpellChecker::setActiveLanguages(const QSet<LanguageManager::LangId> &langs)
 {
     clearSpellers();
+    invalidate();
 
     for (auto const &lang : langs) {
         AspellConfig *conf = aspell_config_clone(config_);
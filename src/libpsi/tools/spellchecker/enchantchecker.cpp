@@ -94,6 +94,7 @@ bool EnchantChecker::add(const QString &word)
             spellers_.first()->add_to_pwl(word.toUtf8().constData());
 #endif
             result = true;
+            invalidate();
         }
     }
     return result;
@@ -115,6 +116,7 @@ QSet<LanguageManager::LangId> EnchantChecker::getAllLanguages() const
 void EnchantChecker::setActiveLanguages(const QSet<LanguageManager::LangId> &langs)
 {
     clearSpellers();
+    invalidate();
 
     for (auto const &lang : langs) {
         auto it = allLanguages_.constFind(lang);
@@ -31,15 +31,19 @@
 #include "config.h"
 #include "languagemanager.h"
 
+#include <QCache>
 #include <QCoreApplication>
 //#include <QDebug>
 #include <QDir>
+#include <QFutureWatcher>
 #include <QLibraryInfo>
 #include <QLocale>
 #include <QMutableListIterator>
+#include <QMutex>
 #include <QSet>
 #include <QString>
 #include <QTextCodec>
+#include <QtConcurrentRun>
 #include <hunspell.hxx>
 
 #ifdef H_DEPRECATED
@@ -49,6 +53,18 @@
 #define HS_STRING(text) li.codec->fromUnicode(text)
 #endif
 
+#define SPELL_CACHE_SIZE 10000     /* words */
+#define SUGGESTIONS_CACHE_SIZE 100 /* words */
+
+// hunspell isn't thread-safe and suggestions are looked up in background. The caches have a lock
+// of their own, so spell checks of cached words don't wait for a suggestion lookup in progress.
+struct HunspellChecker::LangCache {
+    QMutex                       hunspellMutex;
+    QMutex                       mutex; // guards the caches
+    QCache<QString, bool>        spelled { SPELL_CACHE_SIZE };
+    QCache<QString, QStringList> suggested { SUGGESTIONS_CACHE_SIZE };
+};
+
 HunspellChecker::HunspellChecker()
 {
     getDictPaths();
@@ -146,6 +162,7 @@ void HunspellChecker::addLanguage(const LanguageManager::LangId &langId)
             codecName.resize(sizeof("TIS620") - 1);
         }
         li.codec = QTextCodec::codecForName(codecName);
+        li.cache = QSharedPointer<LangCache>::create();
         if (li.codec) {
             li.info.langId   = langId;
             li.info.filename = dic.filePath();
@@ -156,33 +173,98 @@ void HunspellChecker::addLanguage(const LanguageManager::LangId &langId)
     }
 }
 
-QList<QString> HunspellChecker::suggestions(const QString &word)
+bool HunspellChecker::spell(const LangItem &li, const QString &word)
 {
-    QStringList qtResult;
-    for (const LangItem &li : qAsConst(languages_)) {
+    {
+        QMutexLocker locker(&li.cache->mutex);
+        if (auto cached = li.cache->spelled.object(word))
+            return *cached;
+    }
+
+    bool correct;
+    {
+        QMutexLocker locker(&li.cache->hunspellMutex);
+        correct = li.hunspell_->spell(HS_STRING(word)) != 0;
+    }
+    QMutexLocker locker(&li.cache->mutex);
+    li.cache->spelled.insert(word, new bool(correct));
+    return correct;
+}
+
+QStringList HunspellChecker::suggest(const LangItem &li, const QString &word)
+{
+    {
+        QMutexLocker locker(&li.cache->mutex);
+        if (auto cached = li.cache->suggested.object(word))
+            return *cached;
+    }
+
+    QStringList  qtResult;
+    QMutexLocker hunspellLocker(&li.cache->hunspellMutex);
 #ifdef NEW_HUNSPELL
-        std::vector<std::string> result = li.hunspell_->suggest(HS_STRING(word));
-        if (!result.empty()) {
-            for (const std::string &item : result) {
-                qtResult << QString(li.codec->toUnicode(item.c_str()));
-            }
-        }
+    std::vector<std::string> result = li.hunspell_->suggest(HS_STRING(word));
+    for (const std::string &item : result) {
+        qtResult << QString(li.codec->toUnicode(item.c_str()));
+    }
 #else
-        char **result;
-        int    sugNum = li.hunspell_->suggest(&result, HS_STRING(word));
-        for (int i = 0; i < sugNum; i++) {
-            qtResult << li.codec->toUnicode(result[i]);
-        }
-        li.hunspell_->free_list(&result, sugNum);
+    char **result;
+    int    sugNum = li.hunspell_->suggest(&result, HS_STRING(word));
+    for (int i = 0; i < sugNum; i++) {
+        qtResult << li.codec->toUnicode(result[i]);
+    }
+    li.hunspell_->free_list(&result, sugNum);
 #endif
+    hunspellLocker.unlock();
+
+    QMutexLocker locker(&li.cache->mutex);
+    li.cache->suggested.insert(word, new QStringList(qtResult));
+    return qtResult;
+}
+
+QList<QString> HunspellChecker::suggestions(const QString &word)
+{
+    QStringList qtResult;
+    for (const LangItem &li : qAsConst(languages_)) {
+        qtResult += suggest(li, word);
     }
     return std::move(qtResult);
 }
 
+void HunspellChecker::requestSuggestions(const QString &word, QObject *context,
+                                         std::function<void(const QList<QString> &)> callback)
+{
+    bool cached = true;
+    for (const LangItem &li : qAsConst(languages_)) {
+        QMutexLocker locker(&li.cache->mutex);
+        if (!li.cache->suggested.contains(word)) {
+            cached = false;
+            break;
+        }
+    }
+    if (cached) {
+        callback(suggestions(word));
+        return;
+    }
+
+    // the language items are copied so unloading a language won't affect the lookup in progress
+    auto watcher = new QFutureWatcher<QList<QString>>(context);
+    QObject::connect(watcher, &QFutureWatcherBase::finished, context, [watcher, callback]() {
+        callback(watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run([languages = languages_, word]() {
+        QList<QString> ret;
+        for (const LangItem &li : languages) {
+            ret += suggest(li, word);
+        }
+        return ret;
+    }));
+}
+
 bool HunspellChecker::isCorrect(const QString &word)
 {
     for (const LangItem &li : qAsConst(languages_)) {
-        if (li.hunspell_->spell(HS_STRING(word)) != 0) {
+        if (spell(li, word)) {
             return true;
         }
     }
@@ -193,7 +275,13 @@ bool HunspellChecker::add(const QString &word)
     if (!word.isEmpty()) {
         QString trimmed_word = word.trimmed();
         for (const LangItem &li : qAsConst(languages_)) {
+            QMutexLocker hunspellLocker(&li.cache->hunspellMutex);
             if (li.hunspell_->add(HS_STRING(trimmed_word)) != 0) {
+                hunspellLocker.unlock();
+                QMutexLocker locker(&li.cache->mutex);
+                li.cache->spelled.clear();
+                li.cache->suggested.clear();
+                invalidate();
                 return true;
             }
         }
@@ -240,4 +328,6 @@ void HunspellChecker::setActiveLanguages(const QSet<LanguageManager::LangId> &ne
     while (it.hasNext()) {
         addLanguage(it.next());
     }
+    if (!langsToUnload.isEmpty() || !langsToLoad.isEmpty())
+        invalidate();
 }
@@ -51,17 +51,24 @@ public:
     virtual bool                          writable() const;
     virtual void                          setActiveLanguages(const QSet<LanguageManager::LangId> &langs);
     virtual QSet<LanguageManager::LangId> getAllLanguages() const;
+    virtual void                          requestSuggestions(const QString &word, QObject *context,
+                                                             std::function<void(const QList<QString> &)> callback);
 
 private:
     struct DictInfo {
         LanguageManager::LangId langId;
         QString                 filename;
     };
+    struct LangCache;
     struct LangItem {
-        HunspellPtr hunspell_;
-        DictInfo    info;
-        QTextCodec *codec;
+        HunspellPtr               hunspell_;
+        DictInfo                  info;
+        QTextCodec *              codec;
+        QSharedPointer<LangCache> cache;
     };
+    static bool        spell(const LangItem &li, const QString &word);
+    static QStringList suggest(const LangItem &li, const QString &word);
+
     void getSupportedLanguages();
     void addLanguage(const LanguageManager::LangId &langId);
     void getDictPaths();
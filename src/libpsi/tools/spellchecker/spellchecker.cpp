@@ -67,6 +67,13 @@ bool SpellChecker::isCorrect(const QString &) { return true; }
 
 QList<QString> SpellChecker::suggestions(const QString &) { return QList<QString>(); }
 
+void SpellChecker::requestSuggestions(const QString &word, QObject *context,
+                                      std::function<void(const QList<QString> &)> callback)
+{
+    Q_UNUSED(context)
+    callback(suggestions(word));
+}
+
 bool SpellChecker::add(const QString &) { return false; }
 
 SpellChecker *SpellChecker::instance_ = nullptr;
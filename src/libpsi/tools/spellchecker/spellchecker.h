@@ -33,6 +33,8 @@
 #include <QSet>
 #include <QString>
 
+#include <functional>
+
 class SpellChecker : public QObject {
 public:
     static SpellChecker *  instance();
@@ -45,12 +47,23 @@ public:
     virtual void                          setActiveLanguages(const QSet<LanguageManager::LangId> &) { }
     virtual QSet<LanguageManager::LangId> getAllLanguages() const { return QSet<LanguageManager::LangId>(); }
 
+    // The callback is invoked in the thread of the context object when suggestions are ready, unless the context is
+    // deleted first. The default implementation computes suggestions synchronously.
+    virtual void requestSuggestions(const QString &word, QObject *context,
+                                    std::function<void(const QList<QString> &)> callback);
+
+    // changes whenever previous isCorrect() results may become invalid (a word was added, languages changed)
+    inline int revision() const { return revision_; }
+
 protected:
     SpellChecker();
     virtual ~SpellChecker();
 
+    inline void invalidate() { ++revision_; }
+
 private:
     static SpellChecker *instance_;
+    int                  revision_ = 0;
 };
 
 #endif // SPELLCHECKER_H
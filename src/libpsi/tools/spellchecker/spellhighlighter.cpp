@@ -1,8 +1,21 @@
 #include "spellhighlighter.h"
 
-#include "common.h"
 #include "spellchecker.h"
 
+#include <QColor>
+#include <QRegExp>
+#include <algorithm>
+
+namespace {
+// check results of the last highlighting pass of the block
+class SpellBlockData : public QTextBlockUserData {
+public:
+    QString      text;
+    QVector<int> misspelled; // sorted start positions of misspelled words
+    int          revision = -1;
+};
+} // namespace
+
 SpellHighlighter::SpellHighlighter(QTextDocument *d) : QSyntaxHighlighter(d) { }
 
 void SpellHighlighter::highlightBlock(const QString &text)
@@ -10,23 +23,58 @@ void SpellHighlighter::highlightBlock(const QString &text)
     // Underline
     QTextCharFormat tcf;
     tcf.setUnderlineColor(QColor(255, 0, 0));
-    if (qVersionInt() >= 0x040400 && qVersionInt() < 0x040402) {
-        tcf.setUnderlineStyle(QTextCharFormat::DotLine);
-    } else {
-        tcf.setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
+    tcf.setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
+
+    auto checker = SpellChecker::instance();
+    auto data    = static_cast<SpellBlockData *>(currentBlockUserData());
+    if (!data) {
+        data = new SpellBlockData;
+        setCurrentBlockUserData(data);
     }
 
+    // Words which are entirely in the unchanged head or tail of the block (including the boundary characters)
+    // keep the results of the previous pass. So typing re-checks only the words around the edit.
+    const QString &oldText = data->text;
+    int            head    = 0;
+    int            tail    = 0;
+    if (data->revision == checker->revision()) {
+        int common = qMin(oldText.size(), text.size());
+        while (head < common && oldText[head] == text[head])
+            head++;
+        while (tail < common - head && oldText[oldText.size() - 1 - tail] == text[text.size() - 1 - tail])
+            tail++;
+    }
+    const int tailStart = text.size() - tail;
+    const int shift     = oldText.size() - text.size();
+    auto      wasMisspelled
+        = [&data](int oldPos) { return std::binary_search(data->misspelled.begin(), data->misspelled.end(), oldPos); };
+
     // Match words (minimally)
     QRegExp expression("\\b\\w+\\b");
     QRegExp digit("\\d+");
 
     // Iterate through all words
-    int index = text.indexOf(expression);
+    QVector<int> misspelled;
+    int          index = text.indexOf(expression);
     while (index >= 0) {
-        int     length = expression.matchedLength();
-        QString word   = expression.cap();
-        if (!digit.exactMatch(word) && !SpellChecker::instance()->isCorrect(word))
+        int  length = expression.matchedLength();
+        bool wrong;
+        if (index + length < head) {
+            wrong = wasMisspelled(index);
+        } else if (index > tailStart) {
+            wrong = wasMisspelled(index + shift);
+        } else {
+            QString word = expression.cap();
+            wrong        = !digit.exactMatch(word) && !checker->isCorrect(word);
+        }
+        if (wrong) {
             setFormat(index, length, tcf);
+            misspelled.append(index);
+        }
         index = text.indexOf(expression, index + length);
     }
+
+    data->text       = text;
+    data->misspelled = misspelled;
+    data->revision   = checker->revision();
 }
@@ -332,24 +332,48 @@ void ChatEdit::contextMenuEvent(QContextMenuEvent *e)
         QString selected_word = tc.selectedText();
         if (!selected_word.isEmpty() && !QRegExp("\\d+").exactMatch(selected_word)
             && !SpellChecker::instance()->isCorrect(selected_word)) {
-            QList<QString> suggestions = SpellChecker::instance()->suggestions(selected_word);
-            if (!suggestions.isEmpty() || SpellChecker::instance()->writable()) {
-                QMenu spell_menu;
-                if (!suggestions.isEmpty()) {
+            // suggestions may take a while. With a writable dictionary the menu always has something to offer,
+            // so it's shown right away and filled when they are ready. Otherwise it's shown only if there are
+            // suggestions, and the standard menu is shown instead if there are none.
+            const QPoint pos        = e->pos();
+            const QPoint globalPos  = e->globalPos();
+            const bool   writable   = SpellChecker::instance()->writable();
+            auto         spell_menu = new QMenu(this);
+            spell_menu->setAttribute(Qt::WA_DeleteOnClose);
+            QAction *act_pending = spell_menu->addAction(tr("Looking for suggestions..."));
+            act_pending->setEnabled(false);
+            if (writable) {
+                spell_menu->addSeparator();
+                QAction *act_add = spell_menu->addAction(tr("Add to dictionary"));
+                connect(act_add, &QAction::triggered, this, &ChatEdit::addToDictionary);
+            }
+            SpellChecker::instance()->requestSuggestions(
+                selected_word, spell_menu,
+                [this, spell_menu, act_pending, writable, pos, globalPos](const QList<QString> &suggestions) {
+                    if (suggestions.isEmpty()) {
+                        if (writable) {
+                            act_pending->setText(tr("No suggestions"));
+                            return;
+                        }
+                        spell_menu->deleteLater();
+                        QMenu *menu = createStandardContextMenu(pos);
+                        menu->setAttribute(Qt::WA_DeleteOnClose);
+                        menu->popup(globalPos);
+                        return;
+                    }
                     for (const QString &suggestion : suggestions) {
-                        QAction *act_suggestion = spell_menu.addAction(suggestion);
+                        QAction *act_suggestion = new QAction(suggestion, spell_menu);
                         connect(act_suggestion, &QAction::triggered, this, &ChatEdit::applySuggestion);
+                        spell_menu->insertAction(act_pending, act_suggestion);
                     }
-                    spell_menu.addSeparator();
-                }
-                if (SpellChecker::instance()->writable()) {
-                    QAction *act_add = spell_menu.addAction(tr("Add to dictionary"));
-                    connect(act_add, &QAction::triggered, this, &ChatEdit::addToDictionary);
-                }
-                spell_menu.exec(QCursor::pos());
-                e->accept();
-                return;
-            }
+                    delete act_pending;
+                    if (!writable)
+                        spell_menu->popup(globalPos);
+                });
+            if (writable)
+                spell_menu->popup(globalPos);
+            e->accept();
+            return;
         }
     }
 
@@ -403,6 +427,8 @@ void ChatEdit::addToDictionary()
     tc.movePosition(QTextCursor::StartOfWord, QTextCursor::MoveAnchor);
     tc.movePosition(QTextCursor::EndOfWord, QTextCursor::KeepAnchor);
     SpellChecker::instance()->add(tc.selectedText());
+    if (spellhighlighter_)
+        spellhighlighter_->rehighlight();
 
     // Put the cursor where it belongs
     tc.clearSelection();
@@ -116,6 +116,16 @@ void OptionsTabPlugins::listPlugins()
         QString toolTip = QString("<b>%1 %2</b><br/>%3<br/><br/><b>%4:</b><br/>%5<br/><br/><b>%6:</b><br/>%7")
                               .arg(pluginName, pm->version(shortName), TextUtil::plain2rich(pm->description(shortName)),
                                    tr("Authors"), vendors, tr("Plugin Path"), path);
+        if (qint64 loadTime = pm->loadTime(shortName)) {
+            toolTip += QString("<br/><br/><b>%1:</b> %2").arg(tr("Startup time"), tr("%1 ms").arg(loadTime));
+        }
+        if (quint64 calls = pm->stanzaHookCalls(shortName)) {
+            toolTip += QString("<br/><br/><b>%1:</b> %2")
+                           .arg(tr("Stanza hooks"),
+                                tr("%1 calls, about %2 ms")
+                                    .arg(calls)
+                                    .arg(pm->stanzaHookTime(shortName) / 1000000.0, 0, 'f', 1));
+        }
 
         Qt::CheckState   state               = enabled ? Qt::Checked : Qt::Unchecked;
         QTreeWidgetItem *item                = new QTreeWidgetItem(d->tw_Plugins, QTreeWidgetItem::Type);
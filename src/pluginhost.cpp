@@ -53,6 +53,9 @@
 #include <QAction>
 #include <QByteArray>
 #include <QDomElement>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
 #include <QKeySequence>
 #include <QObject>
 #include <QPluginLoader>
@@ -63,6 +66,37 @@
 #include <QTextEdit>
 #include <QWidget>
 
+// reading the clock for every stanza costs more than many hooks do, so only one call
+// out of this many is timed and the total is extrapolated from those
+#define STANZA_HOOK_SAMPLE 16
+
+/**
+ * Times a plugin stanza hook call for the duration of its scope, if it is a sampled one.
+ */
+class StanzaHookTimer {
+public:
+    StanzaHookTimer(quint64 &calls, quint64 &samples, qint64 &time) :
+        samples_(samples), time_(time), timed_(calls++ % STANZA_HOOK_SAMPLE == 0)
+    {
+        if (timed_)
+            timer_.start();
+    }
+
+    ~StanzaHookTimer()
+    {
+        if (timed_) {
+            ++samples_;
+            time_ += timer_.nsecsElapsed();
+        }
+    }
+
+private:
+    quint64 &     samples_;
+    qint64 &      time_;
+    bool          timed_;
+    QElapsedTimer timer_;
+};
+
 /**
  * \brief Constructs a host/wrapper for a plugin.
  *
@@ -180,16 +214,30 @@ QWidget *PluginHost::optionsWidget() const
     return widget;
 }
 
+static QSet<QString> stringSet(const QJsonValue &v)
+{
+    QSet<QString> ret;
+    const auto    arr = v.toArray();
+    for (const auto &item : arr) {
+        ret.insert(item.toString());
+    }
+    return ret;
+}
+
 //-- loading and enabling -------------------------------------------
 void PluginHost::updateMetadata()
 {
     if (plugin_) {
         return;
     }
-    QPluginLoader loader(file_);
-    auto          md = loader.metaData();
-    if (!md.isEmpty())
-        md = md.value("MetaData").toObject();
+    auto md = manager_->cachedMetadata(file_);
+    if (md.isEmpty()) {
+        QPluginLoader loader(file_);
+        md = loader.metaData();
+        if (!md.isEmpty())
+            md = md.value("MetaData").toObject();
+        manager_->cacheMetadata(file_, md);
+    }
 
     QString curLangFull = ":" + TranslationManager::instance()->currentLanguage();
     QString curLang     = curLangFull.section('_', 0, 0);
@@ -205,6 +253,15 @@ void PluginHost::updateMetadata()
     version_   = md.value(QLatin1String("version")).toString();
     priority_  = md.value(QLatin1String("priority")).toInt(2);
 
+    // optional routing hints. for example:
+    // "stanzas": { "kinds": ["message"], "elements": ["body"], "namespaces": ["urn:xmpp:receipts"] }
+    // no "kinds" means all the stanzas. elements/namespaces narrow down by direct children of the stanza.
+    auto stanzas         = md.value(QLatin1String("stanzas")).toObject();
+    stanzaKindsDeclared_ = stanzas.contains(QLatin1String("kinds"));
+    stanzaKinds_         = stringSet(stanzas.value(QLatin1String("kinds")));
+    stanzaElements_      = stringSet(stanzas.value(QLatin1String("elements")));
+    stanzaNamespaces_    = stringSet(stanzas.value(QLatin1String("namespaces")));
+
     description_ = md.value(QLatin1String("description") + curLangFull).toString();
     if (description_.isEmpty())
         description_ = md.value(QLatin1String("description") + curLang).toString();
@@ -277,8 +334,10 @@ bool PluginHost::load()
             // Check it's the right sort of plugin
             PsiPlugin *psiPlugin = qobject_cast<PsiPlugin *>(plugin);
             if (psiPlugin) {
-                plugin_ = plugin;
-                valid_  = true;
+                plugin_       = plugin;
+                valid_        = true;
+                stanzaFilter_ = qobject_cast<StanzaFilter *>(plugin);
+                manager_->invalidateStanzaRoutes();
                 // loaded_ = true;
                 // enabled_ = false;
                 name_ = psiPlugin->name();
@@ -312,6 +371,11 @@ bool PluginHost::load()
     return plugin_ != nullptr;
 }
 
+/**
+ * \brief Returns time in milliseconds spent to load and enable the plugin the last time it was enabled.
+ */
+qint64 PluginHost::loadTime() const { return loadTime_; }
+
 /**
  * \brief Unloads the plugin.
  *
@@ -334,8 +398,10 @@ bool PluginHost::unload()
             iconset_   = nullptr;
             connected_ = false;
             delete loader_;
-            plugin_ = nullptr;
-            loader_ = nullptr;
+            plugin_       = nullptr;
+            loader_       = nullptr;
+            stanzaFilter_ = nullptr;
+            manager_->invalidateStanzaRoutes();
 #ifndef PLUGINS_NO_DEBUG
             qDebug("Plugin unloaded: %s", qPrintable(name_));
 #endif
@@ -366,6 +432,8 @@ bool PluginHost::isLoaded() const { return plugin_ != nullptr; }
  */
 bool PluginHost::enable()
 {
+    QElapsedTimer timer;
+    timer.start();
     if (!enabled_ && load()) {
         if (!connected_) {
 #ifndef PLUGINS_NO_DEBUG
@@ -517,6 +585,7 @@ bool PluginHost::enable()
 
         enableHandler = new QObject(this);
         enabled_      = qobject_cast<PsiPlugin *>(plugin_)->enable();
+        loadTime_     = timer.elapsed();
         if (enabled_)
             emit enabled();
         else
@@ -563,28 +632,22 @@ bool PluginHost::isEnabled() const { return enabled_; }
  *
  * \param account Identifier of the PsiAccount responsible
  * \param xml Incoming XML (may be modified)
+ * \param info Precomputed children names and namespaces of \a xml
  * \return Continue processing the XML stanza; true if the stanza should be silently discarded.
  */
-bool PluginHost::incomingXml(int account, const QDomElement &e)
+bool PluginHost::incomingXml(int account, const QDomElement &e, const PluginStanzaInfo &info)
 {
-    bool handled = false;
+    bool            handled = false;
+    StanzaHookTimer timer(stanzaHookCalls_, stanzaHookSamples_, stanzaHookTime_);
 
     // try stanza filter first
-    StanzaFilter *sf = qobject_cast<StanzaFilter *>(plugin_);
-    if (sf && sf->incomingStanza(account, e)) {
+    if (stanzaFilter_ && (!stanzaKindsDeclared_ || stanzaKinds_.contains(info.kind())) && wantsStanzaContent(info)
+        && stanzaFilter_->incomingStanza(account, e)) {
         handled = true;
     }
     // try iq filters
-    else if (e.tagName() == "iq") {
-        // get iq namespace
-        QString ns;
-        for (QDomNode n = e.firstChild(); !n.isNull(); n = n.nextSibling()) {
-            QDomElement i = n.toElement();
-            if (!i.isNull() && !i.namespaceURI().isNull()) {
-                ns = i.namespaceURI();
-                break;
-            }
-        }
+    else if (info.kind() == QLatin1String("iq") && (!iqNsFilters_.isEmpty() || !iqNsxFilters_.isEmpty())) {
+        const QString ns = info.iqNamespace();
 
         // choose handler function depending on iq type
         bool (IqNamespaceFilter::*handler)(int account, const QDomElement &xml) = nullptr;
@@ -612,6 +675,7 @@ bool PluginHost::incomingXml(int account, const QDomElement &e)
             // regex filters
             QMapIterator<QRegExp, IqNamespaceFilter *> i(iqNsxFilters_);
             while (!handled && i.hasNext()) {
+                i.next();
                 if (i.key().indexIn(ns) >= 0 && (i.value()->*handler)(account, e)) {
                     handled = true;
                 }
@@ -624,12 +688,93 @@ bool PluginHost::incomingXml(int account, const QDomElement &e)
 
 bool PluginHost::outgoingXml(int account, QDomElement &e)
 {
-    bool          handled = false;
-    StanzaFilter *ef      = qobject_cast<StanzaFilter *>(plugin_);
-    if (ef && ef->outgoingStanza(account, e)) {
-        handled = true;
+    if (!stanzaFilter_) {
+        return false;
+    }
+
+    StanzaHookTimer timer(stanzaHookCalls_, stanzaHookSamples_, stanzaHookTime_);
+    return stanzaFilter_->outgoingStanza(account, e);
+}
+
+/**
+ * \brief Returns true if incoming stanzas of given kind (tag name) have to be passed to this plugin.
+ *
+ * Used by PluginManager to build its routing table. Takes into account
+ * the stanza kinds declared in plugin metadata and registered iq namespace filters.
+ */
+bool PluginHost::wantsIncomingStanzas(const QString &kind) const
+{
+    if (!plugin_) {
+        return false;
+    }
+    if (kind == QLatin1String("iq") && (!iqNsFilters_.isEmpty() || !iqNsxFilters_.isEmpty())) {
+        return true;
+    }
+    return stanzaFilter_ && (!stanzaKindsDeclared_ || stanzaKinds_.contains(kind));
+}
+
+bool PluginHost::hasStanzaFilter() const { return stanzaFilter_ != nullptr; }
+
+/**
+ * \brief Returns number of calls to plugin stanza hooks since the plugin was found.
+ */
+quint64 PluginHost::stanzaHookCalls() const { return stanzaHookCalls_; }
+
+/**
+ * \brief Returns estimated time spent in plugin stanza hooks in nanoseconds.
+ */
+qint64 PluginHost::stanzaHookTime() const
+{
+    if (!stanzaHookSamples_) {
+        return 0;
+    }
+    return qint64(double(stanzaHookTime_) * stanzaHookCalls_ / stanzaHookSamples_);
+}
+
+bool PluginHost::wantsStanzaContent(const PluginStanzaInfo &info) const
+{
+    if (stanzaElements_.isEmpty() && stanzaNamespaces_.isEmpty()) {
+        return true;
+    }
+    return info.hasChild(stanzaElements_, stanzaNamespaces_);
+}
+
+PluginStanzaInfo::PluginStanzaInfo(const QDomElement &e) : stanza_(e), kind_(e.tagName()) { }
+
+QString PluginStanzaInfo::iqNamespace() const
+{
+    parseChildren();
+    for (const Child &c : children_) {
+        if (!c.ns.isNull()) {
+            return c.ns;
+        }
+    }
+    return QString();
+}
+
+/**
+ * Returns true if any direct child of the stanza has one of \a elements tag names or \a namespaces.
+ */
+bool PluginStanzaInfo::hasChild(const QSet<QString> &elements, const QSet<QString> &namespaces) const
+{
+    parseChildren();
+    for (const Child &c : children_) {
+        if (elements.contains(c.name) || (!c.ns.isNull() && namespaces.contains(c.ns))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PluginStanzaInfo::parseChildren() const
+{
+    if (parsed_) {
+        return;
+    }
+    parsed_ = true;
+    for (QDomElement i = stanza_.firstChildElement(); !i.isNull(); i = i.nextSiblingElement()) {
+        children_.append({ i.tagName(), i.namespaceURI() });
     }
-    return handled;
 }
 
 //-- for EventFilter ------------------------------------------------
@@ -789,6 +934,7 @@ void PluginHost::addIqNamespaceFilter(const QString &ns, IqNamespaceFilter *filt
 #endif
     } else {
         iqNsFilters_.insert(ns, filter);
+        manager_->invalidateStanzaRoutes();
     }
 }
 
@@ -820,6 +966,7 @@ void PluginHost::addIqNamespaceFilter(const QRegExp &ns, IqNamespaceFilter *filt
 #endif
     } else {
         iqNsxFilters_.insert(ns, filter);
+        manager_->invalidateStanzaRoutes();
     }
 }
 
@@ -832,6 +979,7 @@ void PluginHost::addIqNamespaceFilter(const QRegExp &ns, IqNamespaceFilter *filt
 void PluginHost::removeIqNamespaceFilter(const QString &ns, IqNamespaceFilter *filter)
 {
     iqNsFilters_.remove(ns, filter);
+    manager_->invalidateStanzaRoutes();
 }
 
 /**
@@ -843,6 +991,7 @@ void PluginHost::removeIqNamespaceFilter(const QString &ns, IqNamespaceFilter *f
 void PluginHost::removeIqNamespaceFilter(const QRegExp &ns, IqNamespaceFilter *filter)
 {
     iqNsxFilters_.remove(ns, filter);
+    manager_->invalidateStanzaRoutes();
 }
 
 //-- OptionAccessor -------------------------------------------------
@@ -34,17 +34,45 @@
 #include <QMultiMap>
 #include <QPointer>
 #include <QRegExp>
+#include <QSet>
 #include <QTextEdit>
+#include <QVarLengthArray>
 #include <QVariant>
 
 class IqNamespaceFilter;
 class PluginManager;
 class QPluginLoader;
+class StanzaFilter;
 class QWidget;
 namespace PsiMedia {
 class Provider;
 }
 
+/**
+ * Facts about an incoming stanza shared by all the plugin hosts it is routed to.
+ * The children are looked at once, and only if some plugin asks about them.
+ */
+class PluginStanzaInfo {
+public:
+    explicit PluginStanzaInfo(const QDomElement &e);
+
+    const QString &kind() const { return kind_; }
+    QString        iqNamespace() const; // namespace of the first namespaced child
+    bool           hasChild(const QSet<QString> &elements, const QSet<QString> &namespaces) const;
+
+private:
+    struct Child {
+        QString name;
+        QString ns;
+    };
+    void parseChildren() const;
+
+    QDomElement                       stanza_;
+    QString                           kind_;
+    mutable QVarLengthArray<Child, 8> children_;
+    mutable bool                      parsed_ = false;
+};
+
 class PluginHost : public QObject,
                    public StanzaSendingHost,
                    public IqFilteringHost,
@@ -93,10 +121,11 @@ public:
     QStringList pluginFeatures() const;
 
     // loading
-    void updateMetadata();
-    bool load();
-    bool unload();
-    bool isLoaded() const;
+    void   updateMetadata();
+    qint64 loadTime() const;
+    bool   load();
+    bool   unload();
+    bool   isLoaded() const;
 
     // enabling
     bool enable();
@@ -104,8 +133,14 @@ public:
     bool isEnabled() const;
 
     // for StanzaFilter and IqNamespaceFilter
-    bool incomingXml(int account, const QDomElement &e);
+    bool incomingXml(int account, const QDomElement &e, const PluginStanzaInfo &info);
     bool outgoingXml(int account, QDomElement &e);
+    bool wantsIncomingStanzas(const QString &kind) const;
+    bool hasStanzaFilter() const;
+
+    // time spent in stanza hooks
+    quint64 stanzaHookCalls() const;
+    qint64  stanzaHookTime() const;
 
     // for EventFilter
     bool processEvent(int account, QDomElement &e);
@@ -273,6 +308,7 @@ public:
 
 private:
     bool loadPlugin(QObject *pluginObject);
+    bool wantsStanzaContent(const PluginStanzaInfo &info) const;
 
 signals:
     void enabled();
@@ -288,6 +324,7 @@ private:
     QString           vendor_;
     QString           description_;
     int               priority_ = 0;
+    qint64            loadTime_ = 0; // milliseconds
     QByteArray        rawIcon_;
     QIcon             icon_;
     QPluginLoader *   loader_             = nullptr;
@@ -302,6 +339,16 @@ private:
     bool    hasInfo_   = false;
     QString infoString_;
 
+    // stanzas the plugin declared interest in ("stanzas" object in metadata)
+    bool          stanzaKindsDeclared_ = false;
+    QSet<QString> stanzaKinds_;
+    QSet<QString> stanzaElements_;
+    QSet<QString> stanzaNamespaces_;
+    StanzaFilter *stanzaFilter_      = nullptr;
+    quint64       stanzaHookCalls_   = 0;
+    quint64       stanzaHookSamples_ = 0; // timed calls, see STANZA_HOOK_SAMPLE
+    qint64        stanzaHookTime_    = 0; // nanoseconds spent in the timed calls
+
     QMultiMap<QString, IqNamespaceFilter *> iqNsFilters_;
     QMultiMap<QRegExp, IqNamespaceFilter *> iqNsxFilters_;
     QList<QVariantHash>                     buttons_;
@@ -31,9 +31,12 @@
 #include "xmpp_message.h"
 #include "xmpp_task.h"
 
+#include <QElapsedTimer>
+#include <QJsonDocument>
 #include <QLabel>
 #include <QMetaObject>
 #include <QPluginLoader>
+#include <QSaveFile>
 #include <QtCore>
 #include <QtCrypto>
 
@@ -69,6 +72,11 @@ public:
  */
 static QStringList pluginDirs() { return ApplicationInfo::pluginDirs(); }
 
+static QString metadataCacheFile()
+{
+    return ApplicationInfo::homeDir(ApplicationInfo::CacheLocation) + QLatin1String("/plugins-metadata.json");
+}
+
 /**
  * Method for accessing the singleton instance of the class.
  * Instanciates if no instance yet exists.
@@ -88,6 +96,7 @@ PluginManager *PluginManager::instance()
  */
 PluginManager::PluginManager() : QObject(nullptr), psi_(nullptr)
 {
+    loadMetadataCache();
     updatePluginsList();
     auto const &dirs = pluginDirs();
     for (const QString &path : dirs) {
@@ -150,6 +159,7 @@ QList<PluginHost *> PluginManager::updatePluginsList()
                             }
                             pluginsByPriority_.insert(i, host);
                         }
+                        invalidateStanzaRoutes();
                     }
                 } else {
 #ifndef PLUGINS_NO_DEBUG
@@ -160,9 +170,69 @@ QList<PluginHost *> PluginManager::updatePluginsList()
         }
     }
 
+    if (metadataCacheChanged_) {
+        saveMetadataCache();
+    }
+
     return newPlugins;
 }
 
+void PluginManager::loadMetadataCache()
+{
+    QFile f(metadataCacheFile());
+    if (f.open(QIODevice::ReadOnly)) {
+        metadataCache_ = QJsonDocument::fromJson(f.readAll()).object();
+    }
+}
+
+void PluginManager::saveMetadataCache()
+{
+    // forget plugins which were removed
+    for (auto it = metadataCache_.begin(); it != metadataCache_.end();) {
+        if (QFile::exists(it.key())) {
+            ++it;
+        } else {
+            it = metadataCache_.erase(it);
+        }
+    }
+
+    QSaveFile f(metadataCacheFile());
+    if (f.open(QIODevice::WriteOnly)) {
+        f.write(QJsonDocument(metadataCache_).toJson(QJsonDocument::Compact));
+        if (f.commit()) {
+            metadataCacheChanged_ = false;
+        }
+    }
+}
+
+/**
+ * Returns cached metadata of the plugin file or an empty object
+ * if the file was not seen before or was changed since then.
+ */
+QJsonObject PluginManager::cachedMetadata(const QString &file) const
+{
+    auto      entry = metadataCache_.value(file).toObject();
+    QFileInfo fi(file);
+    if (entry.isEmpty() || entry.value(QLatin1String("size")).toDouble() != double(fi.size())
+        || entry.value(QLatin1String("mtime")).toDouble() != double(fi.lastModified().toMSecsSinceEpoch())) {
+        return QJsonObject();
+    }
+    return entry.value(QLatin1String("metadata")).toObject();
+}
+
+void PluginManager::cacheMetadata(const QString &file, const QJsonObject &metadata)
+{
+    QFileInfo   fi(file);
+    QJsonObject entry;
+    entry.insert(QLatin1String("size"), double(fi.size()));
+    entry.insert(QLatin1String("mtime"), double(fi.lastModified().toMSecsSinceEpoch()));
+    entry.insert(QLatin1String("metadata"), metadata);
+    if (metadataCache_.value(file) != entry) {
+        metadataCache_.insert(file, entry);
+        metadataCacheChanged_ = true;
+    }
+}
+
 /**
  * This slot is executed when the contents of a plugin directory changes
  * It causes the available plugin list to be refreshed.
@@ -189,17 +259,35 @@ void PluginManager::loadEnabledPlugins()
 {
 #ifndef PLUGINS_NO_DEBUG
     qDebug("Loading enabled plugins");
+    QElapsedTimer timer;
+    timer.start();
 #endif
+    QList<PluginHost *> toLoad;
+    for (PluginHost *plugin : qAsConst(pluginsByPriority_)) {
+        if (!plugin->isLoaded() && isEnabledInOptions(plugin)) {
+            toLoad.append(plugin);
+        }
+    }
     for (PluginHost *plugin : qAsConst(pluginsByPriority_)) {
         loadPluginIfEnabled(plugin);
     }
+#ifndef PLUGINS_NO_DEBUG
+    for (PluginHost *plugin : qAsConst(toLoad)) {
+        qDebug("Plugin %s started in %lld ms", qPrintable(plugin->shortName()), plugin->loadTime());
+    }
+    qDebug("Enabled plugins loaded in %lld ms", timer.elapsed());
+#endif
 }
 
-void PluginManager::loadPluginIfEnabled(PluginHost *plugin)
+bool PluginManager::isEnabledInOptions(PluginHost *plugin) const
 {
     const QString option = QString("%1.%2").arg(loadOptionPrefix, plugin->shortName());
-    QVariant      load   = PsiOptions::instance()->getOption(option, false);
-    if (load.toBool()) {
+    return PsiOptions::instance()->getOption(option, false).toBool();
+}
+
+void PluginManager::loadPluginIfEnabled(PluginHost *plugin)
+{
+    if (isEnabledInOptions(plugin)) {
 #ifndef PLUGINS_NO_DEBUG
         qDebug("Plugin %s is enabled in config: loading", qPrintable(plugin->shortName()));
 #endif
@@ -355,6 +443,33 @@ QString PluginManager::description(const QString &plugin) const
     return it == hosts_.end() ? QString() : it.value()->description();
 }
 
+/**
+ * Returns time in milliseconds the named plugin took to load and enable
+ */
+qint64 PluginManager::loadTime(const QString &plugin) const
+{
+    auto it = hosts_.find(plugin);
+    return it == hosts_.end() ? 0 : it.value()->loadTime();
+}
+
+/**
+ * Returns number of stanza hook calls made to the named plugin
+ */
+quint64 PluginManager::stanzaHookCalls(const QString &plugin) const
+{
+    auto it = hosts_.find(plugin);
+    return it == hosts_.end() ? 0 : it.value()->stanzaHookCalls();
+}
+
+/**
+ * Returns time spent by the named plugin in stanza hooks, in nanoseconds
+ */
+qint64 PluginManager::stanzaHookTime(const QString &plugin) const
+{
+    auto it = hosts_.find(plugin);
+    return it == hosts_.end() ? 0 : it.value()->stanzaHookTime();
+}
+
 /**
  * Returns a list of available plugin names found in all plugin directories.
  */
@@ -528,9 +643,16 @@ QList<OAH_PluginOptionsTab *> PluginManager::settingsPages() const { return sett
  */
 bool PluginManager::incomingXml(int account, const QDomElement &xml)
 {
+    const PluginStanzaInfo info(xml);
+    // a copy: hooks may (un)load plugins or change filters, which drops the cached routes
+    const QList<PluginHost *> route = stanzaRoute(info.kind());
+    if (route.isEmpty()) {
+        return false;
+    }
+
     bool handled = false;
-    for (PluginHost *host : qAsConst(pluginsByPriority_)) {
-        if (host->incomingXml(account, xml)) {
+    for (PluginHost *host : route) {
+        if (host->incomingXml(account, xml, info)) {
             handled = true;
             break;
         }
@@ -538,6 +660,30 @@ bool PluginManager::incomingXml(int account, const QDomElement &xml)
     return handled;
 }
 
+/**
+ * Returns loaded plugins which want to see incoming stanzas of the given kind,
+ * in priority order. See PluginHost::wantsIncomingStanzas()
+ */
+const QList<PluginHost *> &PluginManager::stanzaRoute(const QString &kind) const
+{
+    auto it = stanzaRoutes_.find(kind);
+    if (it == stanzaRoutes_.end()) {
+        QList<PluginHost *> route;
+        for (PluginHost *host : pluginsByPriority_) {
+            if (host->wantsIncomingStanzas(kind)) {
+                route.append(host);
+            }
+        }
+        it = stanzaRoutes_.insert(kind, route);
+    }
+    return it.value();
+}
+
+/**
+ * Called by PluginHost when anything affecting stanza routing changes
+ */
+void PluginManager::invalidateStanzaRoutes() { stanzaRoutes_.clear(); }
+
 /**
  * Called by PluginHost when its hosted plugin wants to send xml stanza.
  *
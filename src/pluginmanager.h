@@ -132,8 +132,14 @@ private:
     void                loadAllPlugins();
     bool                verifyStanza(const QString &stanza);
     QList<PluginHost *> updatePluginsList();
+    bool                isEnabledInOptions(PluginHost *plugin) const;
     void                loadPluginIfEnabled(PluginHost *plugin);
 
+    void        loadMetadataCache();
+    void        saveMetadataCache();
+    QJsonObject cachedMetadata(const QString &file) const;
+    void        cacheMetadata(const QString &file, const QJsonObject &metadata);
+
     static PluginManager *instance_;
 
     // account id, client
@@ -149,6 +155,14 @@ private:
     // sorted by priority
     QList<PluginHost *> pluginsByPriority_;
 
+    // file -> { size, mtime, metadata }. lets us list unchanged plugins without reading the binary
+    QJsonObject metadataCache_;
+    bool        metadataCacheChanged_ = false;
+
+    // stanza kind (tag name) -> loaded plugins interested in it, sorted by priority.
+    // built lazily and dropped whenever a plugin is (un)loaded or changes its filters
+    mutable QHash<QString, QList<PluginHost *>> stanzaRoutes_;
+
     QList<QCA::DirWatch *> dirWatchers_;
 
     // Options widget provides by plugin on opt_plugins
@@ -159,7 +173,9 @@ private:
     QTimer *                                                    _messageViewJSFiltersTimer = nullptr;
 
     class StreamWatcher;
-    bool    incomingXml(int account, const QDomElement &eventXml);
+    bool                       incomingXml(int account, const QDomElement &eventXml);
+    const QList<PluginHost *> &stanzaRoute(const QString &kind) const;
+    void                       invalidateStanzaRoutes();
     void    sendXml(int account, const QString &xml);
     QString uniqueId(int account) const;
 
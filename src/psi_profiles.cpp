@@ -135,6 +135,7 @@ void UserAccount::reset()
     pgpDisabledChats.clear();
 
     roster.clear();
+    roster.setVersion(QString());
 }
 
 UserAccount::~UserAccount() { }
@@ -256,6 +257,8 @@ void UserAccount::fromOptions(OptionsTree *o, QString base)
         ri.setGroups(o->getOption(rbase + ".groups").toStringList());
         roster += ri;
     }
+    // XEP-0237 version of the cached roster above
+    roster.setVersion(o->getOption(base + ".roster-version").toString());
 
     groupState.clear();
     QVariantList states = o->mapKeyList(base + ".group-state");
@@ -399,6 +402,7 @@ void UserAccount::toOptions(OptionsTree *o, QString base)
         o->setOption(rbase + ".ask", ri.ask());
         o->setOption(rbase + ".groups", ri.groups());
     }
+    o->setOption(base + ".roster-version", roster.version());
 
     // now we check for redundant entries
     QStringList   groupList;
@@ -116,6 +116,7 @@
 #include "xmpp_caps.h"
 #include "xmpp_captcha.h"
 #include "xmpp_serverinfomanager.h"
+#include "xmpp_streamcapture.h"
 #include "xmpp_tasks.h"
 #include "xmpp_xmlcommon.h"
 #ifdef FILETRANSFER
@@ -139,9 +140,13 @@
 #endif
 
 #include <QApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QFrame>
+#include <QHash>
 #include <QHostInfo>
 #include <QIcon>
 #include <QInputDialog>
@@ -154,6 +159,8 @@
 #include <QPointer>
 #include <QPushButton>
 #include <QQueue>
+#include <QRegularExpression>
+#include <QSet>
 #include <QTimer>
 #include <QUrl>
 #include <QtCrypto>
@@ -162,6 +169,8 @@
 #include <qt5keychain/keychain.h>
 #endif
 
+#include <memory>
+
 /*#ifdef Q_OS_WIN
 #    include <windows.h>
 typedef int socklen_t;
@@ -361,7 +370,7 @@ static QList<ReconnectData> reconnectData()
     return data;
 }
 
-class PsiAccount::Private : public Alertable {
+class PsiAccount::Private : public Alertable, public XMPP::StreamCapture {
     Q_OBJECT
 public:
     Private(PsiAccount *parent) : Alertable(parent), account(parent), xmlRingbuf(1000)
@@ -415,6 +424,17 @@ public:
     QTimer                  *updateOnlineContactsCountTimer_ = nullptr;
     QTimer                  *logoutTimer                     = nullptr;
 
+    // XEP-0352. while inactive only the latest presence of each resource is kept
+    // and passed further when the client becomes active again
+    struct PendingPresence {
+        Jid      jid;
+        Resource resource;
+        bool     available;
+    };
+    bool                            clientActive = true;
+    QHash<QString, PendingPresence> pendingPresences; // full jid -> presence
+    QStringList                     pendingPresenceOrder;
+
     // Tune
     Tune lastTune;
 
@@ -467,8 +487,17 @@ public:
     QPointer<QCATLSHandler>     tlsHandler;
     bool                        usingSSL = false;
 
-    QVector<xmlRingElem> xmlRingbuf;
-    int                  xmlRingbufWrite = 0;
+    // stanzas are kept unserialized and turned into text only when the xml console dumps them
+    struct RingItem {
+        int         type = RingXmlIn;
+        qint64      time = 0; // msecs since epoch
+        QDomElement stanza;
+    };
+    QVector<RingItem> xmlRingbuf;
+    int               xmlRingbufWrite = 0;
+
+    std::unique_ptr<QFile>                     captureFile;
+    std::unique_ptr<XMPP::StreamCaptureWriter> captureWriter;
 
     QHostAddress localAddress;
 
@@ -704,19 +733,48 @@ public slots:
         emit account->disconnected();
     }
 
-    void client_xmlIncoming(const QString &s)
+    void client_stanzaIncoming(const QDomElement &e) { addRingItem(RingXmlIn, e); }
+    void client_stanzaOutgoing(const QDomElement &e) { addRingItem(RingXmlOut, e); }
+    void addRingItem(int type, const QDomElement &e)
+    {
+        RingItem &item  = xmlRingbuf[xmlRingbufWrite];
+        item.type       = type;
+        item.time       = QDateTime::currentMSecsSinceEpoch();
+        item.stanza     = e;
+        xmlRingbufWrite = (xmlRingbufWrite + 1) % xmlRingbuf.count();
+    }
+
+    // raw stream data goes to the capture file only
+    void capture(Direction direction, qint64 timestamp, const QByteArray &data) override
+    {
+        if (captureWriter)
+            captureWriter->capture(direction, timestamp, data);
+    }
+
+    void startCapture()
     {
-        xmlRingbuf[xmlRingbufWrite].type = RingXmlIn;
-        xmlRingbuf[xmlRingbufWrite].xml  = s;
-        xmlRingbuf[xmlRingbufWrite].time = QDateTime::currentDateTime();
-        xmlRingbufWrite                  = (xmlRingbufWrite + 1) % xmlRingbuf.count();
+        stopCapture();
+        QString dir = PsiOptions::instance()->getOption("options.xml-console.capture-directory").toString();
+        if (dir.isEmpty())
+            return;
+
+        QString name = QString("%1-%2.xmppcap")
+                           .arg(jid.bare(), QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"))
+                           .replace(QRegularExpression("[^\\w@.-]"), "_");
+        captureFile.reset(new QFile(QDir(dir).filePath(name)));
+        if (!captureFile->open(QIODevice::WriteOnly)) {
+            qWarning("Failed to open the stream capture %s: %s", qPrintable(captureFile->fileName()),
+                     qPrintable(captureFile->errorString()));
+            captureFile.reset();
+            return;
+        }
+        captureWriter.reset(new XMPP::StreamCaptureWriter(captureFile.get()));
     }
-    void client_xmlOutgoing(const QString &s)
+
+    void stopCapture()
     {
-        xmlRingbuf[xmlRingbufWrite].type = RingXmlOut;
-        xmlRingbuf[xmlRingbufWrite].xml  = s;
-        xmlRingbuf[xmlRingbufWrite].time = QDateTime::currentDateTime();
-        xmlRingbufWrite                  = (xmlRingbufWrite + 1) % xmlRingbuf.count();
+        captureWriter.reset();
+        captureFile.reset();
     }
 
     void client_stanzaElementOutgoing(QDomElement &s)
@@ -774,11 +832,14 @@ public:
     // implementation for QList<PsiAccount::xmlRingElem> PsiAccount::dumpRingbuf()
     QList<xmlRingElem> dumpRingbuf()
     {
-        xmlRingElem        el;
         QList<xmlRingElem> ret;
         for (int i = 0; i < xmlRingbuf.count(); i++) {
-            el = xmlRingbuf[(xmlRingbufWrite + i) % xmlRingbuf.count()];
-            if (!el.xml.isEmpty()) {
+            const RingItem &item = xmlRingbuf[(xmlRingbufWrite + i) % xmlRingbuf.count()];
+            if (!item.stanza.isNull()) {
+                xmlRingElem el;
+                el.type = item.type;
+                el.time = QDateTime::fromMSecsSinceEpoch(item.time);
+                el.xml  = XMPP::Stream::xmlToString(item.stanza) + '\n';
                 ret += el;
             }
         }
@@ -1050,7 +1111,9 @@ PsiAccount::PsiAccount(const UserAccount &acc, PsiContactList *parent, TabManage
     d->acc.groupState = acc.groupState;
 
     // create XMPP::Client
-    d->client = new Client;
+    d->client       = new Client;
+    d->clientActive = d->psi->isClientActive();
+    d->client->setClientActive(d->clientActive);
 
     // Plugins
 #ifdef PSI_PLUGINS
@@ -1087,20 +1150,21 @@ PsiAccount::PsiAccount(const UserAccount &acc, PsiContactList *parent, TabManage
     connect(d->client, &Client::rosterItemAdded, this, &PsiAccount::client_rosterItemUpdated);
     connect(d->client, &Client::rosterItemUpdated, this, &PsiAccount::client_rosterItemUpdated);
     connect(d->client, &Client::rosterItemRemoved, this, &PsiAccount::client_rosterItemRemoved);
-    connect(d->client, &Client::resourceAvailable, this, &PsiAccount::client_resourceAvailable);
-    connect(d->client, &Client::resourceUnavailable, this, &PsiAccount::client_resourceUnavailable);
+    connect(d->client, &Client::resourceAvailable, this,
+            [this](const Jid &j, const Resource &r) { queueResourcePresence(j, r, true); });
+    connect(d->client, &Client::resourceUnavailable, this,
+            [this](const Jid &j, const Resource &r) { queueResourcePresence(j, r, false); });
     connect(d->client, &Client::presenceError, this, &PsiAccount::client_presenceError);
     connect(d->client, &Client::messageReceived, this, &PsiAccount::client_messageReceived);
     connect(d->client, &Client::subscription, this, &PsiAccount::client_subscription);
-    connect(d->client, &Client::debugText, this, &PsiAccount::client_debugText);
     connect(d->client, &Client::groupChatJoined, this, &PsiAccount::client_groupChatJoined);
     connect(d->client, &Client::groupChatLeft, this, &PsiAccount::client_groupChatLeft);
     connect(d->client, &Client::groupChatPresence, this, &PsiAccount::client_groupChatPresence);
     connect(d->client, &Client::groupChatError, this, &PsiAccount::client_groupChatError);
     connect(d->client, &Client::beginImportRoster, this, &PsiAccount::beginBulkContactUpdate);
     connect(d->client, &Client::endImportRoster, this, &PsiAccount::endBulkContactUpdate);
-    connect(d->client, &Client::xmlIncoming, d, &Private::client_xmlIncoming);
-    connect(d->client, &Client::xmlOutgoing, d, &Private::client_xmlOutgoing);
+    connect(d->client, &Client::stanzaIncoming, d, &Private::client_stanzaIncoming);
+    connect(d->client, &Client::stanzaOutgoing, d, &Private::client_stanzaOutgoing);
     connect(d->client, &Client::stanzaElementOutgoing, d, &Private::client_stanzaElementOutgoing);
 
     // Privacy manager
@@ -1178,6 +1242,7 @@ PsiAccount::PsiAccount(const UserAccount &acc, PsiContactList *parent, TabManage
     // restore cached roster
     for (const auto &it : qAsConst(acc.roster))
         client_rosterItemUpdated(it);
+    d->client->setCachedRoster(acc.roster);
 
     // restore pgp key bindings
     setKnownPgpKeys(acc.pgpKnownKeys);
@@ -1286,6 +1351,7 @@ void PsiAccount::cleanupStream()
 {
     // GSOC: Get SM state out of stream
     delete d->stream;
+    d->stopCapture();
 
     delete d->tls;
     d->tls        = nullptr;
@@ -1358,6 +1424,7 @@ const UserAccount &PsiAccount::userAccount() const
 {
     // save the roster and pgp key bindings
     d->acc.roster.clear();
+    d->acc.roster.setVersion(d->client->roster().version());
     d->acc.pgpKnownKeys.clear();
     for (UserListItem *u : qAsConst(d->userList)) {
         if (u->inList())
@@ -1714,9 +1781,14 @@ void PsiAccount::login()
     connect(d->stream, &ClientStream::delayedCloseFinished, this, &PsiAccount::cs_delayedCloseFinished);
     connect(d->stream, &ClientStream::warning, this, &PsiAccount::cs_warning);
     connect(d->stream, &ClientStream::error, this, &PsiAccount::cs_error, Qt::QueuedConnection);
+    d->startCapture();
+    if (d->captureWriter)
+        d->stream->setCapture(d);
 
     Jid j = d->jid.withResource((d->acc.opt_automatic_resource ? localHostName() : d->acc.resource));
     d->stream->setSMEnabled(d->acc.opt_sm);
+    d->stream->setSMSpill(ApplicationInfo::currentProfileDir(ApplicationInfo::CacheLocation) + "/sm",
+                          PsiOptions::instance()->getOption("options.stream-management.spill-size").toInt());
     d->client->connectToServer(d->stream, j);
 }
 
@@ -1977,10 +2049,67 @@ void PsiAccount::sessionStarted()
             u->setFlagForDelete(true);
     }
 
+    // XEP-0352 state is reset for a new session
+    setClientActive(d->psi->isClientActive());
+    d->client->setClientActive(d->clientActive);
+
     // ask for roster
     d->client->rosterRequest();
 }
 
+/**
+ * Called when the user starts or stops interacting with the application.
+ * While inactive, the server is asked to hold back unimportant traffic (XEP-0352)
+ * and presences are merged per resource, so the contact list is updated once we are active again.
+ */
+void PsiAccount::setClientActive(bool active)
+{
+    if (d->clientActive == active)
+        return;
+
+    d->clientActive = active;
+    d->client->setClientActive(active);
+    if (active)
+        flushResourcePresences();
+}
+
+void PsiAccount::queueResourcePresence(const Jid &j, const Resource &r, bool available)
+{
+    if (d->clientActive) {
+        if (available)
+            client_resourceAvailable(j, r);
+        else
+            client_resourceUnavailable(j, r);
+        return;
+    }
+
+    QString key = j.full();
+    if (!d->pendingPresences.contains(key))
+        d->pendingPresenceOrder.append(key);
+    d->pendingPresences.insert(key, { j, r, available });
+}
+
+void PsiAccount::flushResourcePresences()
+{
+    if (d->pendingPresenceOrder.isEmpty())
+        return;
+
+    const auto order     = d->pendingPresenceOrder;
+    const auto presences = d->pendingPresences;
+    d->pendingPresenceOrder.clear();
+    d->pendingPresences.clear();
+
+    emit beginBulkContactUpdate();
+    for (const QString &key : order) {
+        const auto &p = presences[key];
+        if (p.available)
+            client_resourceAvailable(p.jid, p.resource);
+        else
+            client_resourceUnavailable(p.jid, p.resource);
+    }
+    emit endBulkContactUpdate();
+}
+
 void PsiAccount::cs_connectionClosed()
 {
     if (isDisconnecting)
@@ -2297,11 +2426,19 @@ void PsiAccount::client_rosterRequestFinished(bool success, int, const QString &
     if (success) {
         // printf("PsiAccount: [%s] roster retrieved ok.  %d entries.\n", name().latin1(), d->client->roster().count());
 
+        // with roster versioning the roster may be unchanged and items restored from cache are
+        // not reported by the client again. so we keep everything still present in client's roster.
+        QSet<QString> rosterJids;
+        for (const auto &i : d->client->roster())
+            rosterJids.insert(i.jid().full());
+
         // delete flagged items
         QMutableListIterator<UserListItem *> it(d->userList);
         while (it.hasNext()) {
             auto u = it.next();
-            if (u->flagForDelete()) {
+            if (u->flagForDelete() && rosterJids.contains(u->jid().full())) {
+                u->setFlagForDelete(false);
+            } else if (u->flagForDelete()) {
                 // QMessageBox::information(0, "blah", QString("deleting: [%1]").arg(u->jid().full()));
 
                 d->eventQueue->clear(u->jid());
@@ -2985,13 +3122,6 @@ void PsiAccount::client_subscription(const Jid &j, const QString &str, const QSt
     handleEvent(ae, IncomingStanza);
 }
 
-void PsiAccount::client_debugText(const QString &txt)
-{
-    Q_UNUSED(txt);
-    // printf("%s\n", qPrintable(txt));
-    // fflush(stdout);
-}
-
 #ifdef GOOGLE_FT
 void PsiAccount::incomingGoogleFileTransfer(GoogleFileTransfer *ft)
 {
@@ -3719,6 +3849,10 @@ void PsiAccount::simulateContactOffline(UserListItem *u)
 
 void PsiAccount::simulateRosterOffline()
 {
+    // these are outdated now
+    d->pendingPresences.clear();
+    d->pendingPresenceOrder.clear();
+
     emit beginBulkContactUpdate();
 
     notifyOnlineOk = false;
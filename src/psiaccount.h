@@ -150,6 +150,7 @@ public:
     enum AutoAway { AutoAway_None = 0, AutoAway_Away, AutoAway_XA, AutoAway_Offline };
 
     void setAutoAwayStatus(AutoAway status);
+    void setClientActive(bool active);
 
     bool               noPopup() const;
     bool               loggedIn() const;
@@ -450,7 +451,6 @@ private slots:
     void client_presenceError(const Jid &, int, const QString &);
     void client_messageReceived(const Message &);
     void client_subscription(const Jid &, const QString &, const QString &);
-    void client_debugText(const QString &);
     void client_groupChatJoined(const Jid &);
     void client_groupChatLeft(const Jid &);
     void client_groupChatPresence(const Jid &, const Status &);
@@ -529,6 +529,8 @@ private:
     void          deleteAllDialogs();
     void          simulateContactOffline(UserListItem *);
     void          simulateRosterOffline();
+    void          queueResourcePresence(const Jid &j, const Resource &r, bool available);
+    void          flushResourcePresences();
     void          cpUpdate(const UserListItem &, const QString &rname = "", bool fromPresence = false);
     UserListItem *addUserListItem(const Jid &jid, const QString &nick = "");
     void          logEvent(const Jid &, const PsiEvent::Ptr &, int);
@@ -16,6 +16,17 @@ void PsiCapsRegistry::saveData(const QByteArray &data)
     file.write(data);
 }
 
+bool PsiCapsRegistry::appendData(const QByteArray &data)
+{
+    QFile          file(ApplicationInfo::homeDir(ApplicationInfo::CacheLocation) + "/caps.xml");
+    IODeviceOpener opener(&file, QIODevice::WriteOnly | QIODevice::Append);
+    if (!opener.isOpen()) {
+        qWarning("Caps: Unable to open IO device");
+        return false;
+    }
+    return file.write(data) == data.size();
+}
+
 QByteArray PsiCapsRegistry::loadData()
 {
     QFile file(ApplicationInfo::homeDir(ApplicationInfo::CacheLocation) + "/caps.xml");
@@ -11,6 +11,7 @@ public:
 
     void       saveData(const QByteArray &data);
     QByteArray loadData();
+    bool       appendData(const QByteArray &data);
 };
 
 #endif // PSICAPSREGSITRY_H
@@ -132,6 +132,8 @@
 #include <QPointer>
 #include <QSessionManager>
 
+#define CSI_IDLE_TIMEOUT 300 /* seconds. user is not looking at visible windows anymore */
+
 static const char *tunePublishOptionPath          = "options.extended-presence.tune.publish";
 static const char *tuneUrlFilterOptionPath        = "options.extended-presence.tune.url-filter";
 static const char *tuneTitleFilterOptionPath      = "options.extended-presence.tune.title-filter";
@@ -342,6 +344,9 @@ public:
     };
 
     IdleSettings idleSettings_;
+
+    // XEP-0352. false if the user doesn't look at or doesn't use the app
+    bool clientActive = true;
 };
 
 //----------------------------------------------------------------------------
@@ -362,7 +367,6 @@ PsiCon::PsiCon() : QObject(nullptr)
     XMPP::CapsRegistry::setInstance(new PsiCapsRegistry(this));
     XMPP::CapsRegistry *pcr = XMPP::CapsRegistry::instance();
     connect(pcr, SIGNAL(destroyed(QObject *)), pcr, SLOT(save()));
-    connect(pcr, SIGNAL(registered(const XMPP::CapsSpec &)), pcr, SLOT(save()));
     pcr->load();
 }
 
@@ -601,6 +605,7 @@ bool PsiCon::init()
     }
 
     connect(&d->idle, SIGNAL(secondsIdle(int)), SLOT(secondsIdle(int)));
+    connect(qApp, &QGuiApplication::applicationStateChanged, this, &PsiCon::updateClientState);
 
     // PopupDurationsManager
     d->popupManager = new PopupManager(this);
@@ -1944,10 +1949,41 @@ void PsiCon::secondsIdle(int sec)
 
         pa->setAutoAwayStatus(aa);
     }
+
+    updateClientState();
 }
 
 int PsiCon::idle() const { return d->idleSettings_.secondsIdle; }
 
+bool PsiCon::isClientActive() const { return d->clientActive; }
+
+/**
+ * The client is considered inactive when it doesn't have focus and either none of its windows
+ * is shown or the user is idle (if idle detection is enabled).
+ */
+void PsiCon::updateClientState()
+{
+    bool active = QGuiApplication::applicationState() == Qt::ApplicationActive;
+    if (!active && d->idleSettings_.secondsIdle < CSI_IDLE_TIMEOUT) {
+        const auto widgets = QApplication::topLevelWidgets();
+        for (QWidget *w : widgets) {
+            if (w->isVisible() && !w->isMinimized()) {
+                active = true;
+                break;
+            }
+        }
+    }
+
+    if (d->clientActive == active)
+        return;
+
+    d->clientActive = active;
+    // disabled accounts too, so they are in sync once re-enabled
+    for (PsiAccount *pa : d->contactList->accounts()) {
+        pa->setClientActive(active);
+    }
+}
+
 ContactUpdatesManager *PsiCon::contactUpdatesManager() const { return contactUpdatesManager_; }
 
 #include "psicon.moc"
@@ -90,6 +90,7 @@ public:
     void     dialogRegister(QWidget *w);
     void     dialogUnregister(QWidget *w);
     int      idle() const;
+    bool     isClientActive() const;
 
     QMenuBar *defaultMenuBar() const;
 
@@ -188,6 +189,7 @@ private slots:
     void startBounce();
     void aboutToQuit();
     void secondsIdle(int);
+    void updateClientState();
     void proceedWithSleep();
     void networkSessionOpened();
 
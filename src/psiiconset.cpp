@@ -31,6 +31,7 @@
 #include <QSet>
 #include <QStandardPaths>
 #include <QTextStream>
+#include <QtConcurrentMap>
 
 using namespace XMPP;
 
@@ -109,7 +110,7 @@ public:
 
     Private(PsiIconset *_psi) { psi = _psi; }
 
-    QString iconsetPath(QString name, Iconset::Format format = Iconset::Format::Psi)
+    static QString iconsetPath(QString name, Iconset::Format format = Iconset::Format::Psi)
     {
         if (format == Iconset::Format::Psi) {
             const auto &dataDirs = ApplicationInfo::dataDirs();
@@ -136,7 +137,7 @@ public:
         return QString();
     }
 
-    void stripFirstAnimFrame(Iconset &is)
+    static void stripFirstAnimFrame(Iconset &is)
     {
         QListIterator<PsiIcon *> it = is.iterator();
         while (it.hasNext()) {
@@ -144,7 +145,7 @@ public:
         }
     }
 
-    void loadIconset(Iconset *to, Iconset *from)
+    static void loadIconset(Iconset *to, Iconset *from)
     {
         if (!to) {
             qWarning("PsiIconset::loadIconset(): 'to' iconset is NULL!");
@@ -249,96 +250,98 @@ public:
         return def;
     }
 
-    Iconset moodsIconset(bool *ok)
-    {
+    /*
+     * Default iconset of some type (moods, clients, etc) with icons of the
+     * iconset selected in options on top of it.
+     * Doesn't touch options or the iconset factory, so may be run in a worker thread.
+     */
+    struct TypedIconset {
+        QString type;
+        QString name;
+        bool    ok = false;
         Iconset def;
-        *ok = def.load(iconsetPath("moods/default"));
-
-        if (PsiOptions::instance()->getOption("options.iconsets.moods").toString() != "default") {
-            Iconset is;
-            is.load(iconsetPath("moods/" + PsiOptions::instance()->getOption("options.iconsets.moods").toString()));
-
-            loadIconset(&def, &is);
+        Iconset selected;
+
+        void load()
+        {
+            ok = def.load(iconsetPath(type + "/default"));
+            if (name != "default") {
+                selected.load(iconsetPath(type + "/" + name));
+                loadIconset(&def, &selected);
+            }
+            stripFirstAnimFrame(def);
         }
+    };
 
-        stripFirstAnimFrame(def);
+    // iconsets loaded in advance by PsiIconset::loadAll(). type -> iconset
+    QMap<QString, TypedIconset> prefetched;
 
-        return def;
-    }
+    static QString typedIconsetOption(const QString &type) { return "options.iconsets." + type; }
 
-    Iconset activityIconset(bool *ok)
+    Iconset typedIconset(const QString &type, bool *ok)
     {
-        Iconset def;
-        *ok = def.load(iconsetPath("activities/default"));
+        const QString name = PsiOptions::instance()->getOption(typedIconsetOption(type)).toString();
 
-        if (PsiOptions::instance()->getOption("options.iconsets.activities").toString() != "default") {
-            Iconset is;
-            is.load(iconsetPath("activities/"
-                                + PsiOptions::instance()->getOption("options.iconsets.activities").toString()));
-
-            loadIconset(&def, &is);
+        auto it = prefetched.find(type);
+        if (it != prefetched.end() && it.value().name == name) {
+            *ok = it.value().ok;
+            return prefetched.take(type).def;
         }
 
-        stripFirstAnimFrame(def);
-
-        return def;
+        TypedIconset is;
+        is.type = type;
+        is.name = name;
+        is.load();
+        *ok = is.ok;
+        return is.def;
     }
 
-    Iconset clientsIconset(bool *ok)
-    {
-        Iconset def;
-        *ok = def.load(iconsetPath("clients/default"));
+    Iconset moodsIconset(bool *ok) { return typedIconset("moods", ok); }
 
-        if (PsiOptions::instance()->getOption("options.iconsets.clients").toString() != "default") {
-            Iconset is;
-            is.load(iconsetPath("clients/" + PsiOptions::instance()->getOption("options.iconsets.clients").toString()));
+    Iconset activityIconset(bool *ok) { return typedIconset("activities", ok); }
 
-            loadIconset(&def, &is);
-        }
+    Iconset clientsIconset(bool *ok) { return typedIconset("clients", ok); }
 
-        stripFirstAnimFrame(def);
-
-        return def;
-    }
+    Iconset affiliationsIconset(bool *ok) { return typedIconset("affiliations", ok); }
 
-    Iconset affiliationsIconset(bool *ok)
+    QList<Iconset *> emoticons()
     {
-        Iconset def;
-        *ok = def.load(iconsetPath("affiliations/default"));
-
-        if (PsiOptions::instance()->getOption("options.iconsets.affiliations").toString() != "default") {
-            Iconset is;
-            is.load(iconsetPath("affiliations/"
-                                + PsiOptions::instance()->getOption("options.iconsets.affiliations").toString()));
+        struct Emoticons {
+            QString  name;
+            Iconset *psi     = nullptr;
+            Iconset *kde     = nullptr;
+            Iconset *success = nullptr;
+        };
 
-            loadIconset(&def, &is);
+        // Emoticon iconsets are independent, so parse them in parallel.
+        // Iconsets are created and deleted here since the factory isn't thread safe
+        QList<Emoticons> list;
+        const auto       names = PsiOptions::instance()->getOption("options.iconsets.emoticons").toStringList();
+        for (const QString &name : names) {
+            list.append({ name, new Iconset, new Iconset });
         }
+        QtConcurrent::blockingMap(list, [](Emoticons &e) {
+            if (e.psi->load(iconsetPath("emoticons/" + e.name))) {
+                e.success = e.psi;
+            } else if (e.kde->load(iconsetPath(e.name, Iconset::Format::KdeEmoticons),
+                                   Iconset::Format::KdeEmoticons)) {
+                e.success = e.kde;
+            }
+        });
 
-        stripFirstAnimFrame(def);
-
-        return def;
-    }
-
-    QList<Iconset *> emoticons()
-    {
         QList<Iconset *> emo;
-
-        const auto names = PsiOptions::instance()->getOption("options.iconsets.emoticons").toStringList();
-        for (const QString &name : names) {
-            Iconset *is = new Iconset;
-            if (is->load(iconsetPath("emoticons/" + name))) {
+        for (const Emoticons &e : qAsConst(list)) {
+            if (e.success) {
                 // PsiIconset::removeAnimation(is);
-                is->addToFactory();
-                emo.append(is);
-                continue;
+                e.success->addToFactory();
+                emo.append(e.success);
+            }
+            if (e.psi != e.success) {
+                delete e.psi;
+            }
+            if (e.kde != e.success) {
+                delete e.kde;
             }
-            delete is;
-            is = new Iconset;
-            if (is->load(iconsetPath(name, Iconset::Format::KdeEmoticons), Iconset::Format::KdeEmoticons)) {
-                is->addToFactory();
-                emo.append(is);
-            } else
-                delete is;
         }
 
         return emo;
@@ -659,15 +662,34 @@ void PsiIconset::loadStatusIconDefinitions()
 
 bool PsiIconset::loadAll()
 {
-    if (!loadSystem() || !loadRoster())
+    // These don't depend on each other or on system and roster iconsets,
+    // so parse them in parallel while system and roster are loaded here
+    QList<Private::TypedIconset> typed;
+    for (const QString &type : { "moods", "activities", "clients", "affiliations" }) {
+        Private::TypedIconset is;
+        is.type = type;
+        is.name = PsiOptions::instance()->getOption(Private::typedIconsetOption(type)).toString();
+        typed.append(is);
+    }
+    auto future = QtConcurrent::map(typed, [](Private::TypedIconset &is) { is.load(); });
+
+    bool ok = loadSystem() && loadRoster();
+    future.waitForFinished();
+    if (!ok)
         return false;
 
+    for (const auto &is : qAsConst(typed)) {
+        d->prefetched.insert(is.type, is);
+    }
+    typed.clear();
+
     loadEmoticons();
     loadMoods();
     loadActivity();
     loadClients();
     loadAffiliations();
     loadStatusIconDefinitions();
+    d->prefetched.clear();
     return true;
 }
 
@@ -431,6 +431,19 @@ void RtpChannel::write(const RtpPacket &rtp)
     }
 }
 
+RtpChannel::Stats RtpChannel::stats() const
+{
+    Stats ret;
+    if (d->c) {
+        PRtpChannelStats ps = d->c->stats();
+        ret.received        = ps.received;
+        ret.dropped         = ps.dropped;
+        ret.maxDepth        = ps.maxDepth;
+        ret.maxLatency      = ps.maxLatency;
+    }
+    return ret;
+}
+
 void RtpChannel::connectNotify(const QMetaMethod &signal)
 {
     int oldtotal = d->readyReadListeners;
@@ -204,9 +204,19 @@ class RtpChannel : public QObject {
     Q_OBJECT
 
 public:
+    // queue counters, for diagnosing a congested media path
+    class Stats {
+    public:
+        quint64 received   = 0; // packets received from the media engine
+        quint64 dropped    = 0; // packets dropped because they were not read fast enough
+        int     maxDepth   = 0; // deepest the receive queue got
+        qint64  maxLatency = 0; // longest delay until packets were handed over, in ms
+    };
+
     int       packetsAvailable() const;
     RtpPacket read();
     void      write(const RtpPacket &rtp);
+    Stats     stats() const;
 
 signals:
     void readyRead();
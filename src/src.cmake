@@ -264,9 +264,11 @@ list(APPEND HEADERS
 if(UNIX OR IS_WEBENGINE)
     list(APPEND SOURCES
         filesharinghttpproxy.cpp
+        httpconditional.cpp
         webserver.cpp)
     list(APPEND HEADERS
         filesharinghttpproxy.h
+        httpconditional.h
         webserver.h)
 endif()
 
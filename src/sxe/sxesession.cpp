@@ -28,6 +28,16 @@ using namespace XMPP;
 
 // The maxlength of a chdata that gets put in one edit
 enum { MAXCHDATA = 1024 };
+// How long flushed edits are held back to be sent together (msecs)
+enum { FLUSH_INTERVAL = 50 };
+
+namespace {
+// QDomNode equality compares the private implementation pointers. The same pointer identifies a node in hashes.
+class DomNodeId : public QDomNode {
+public:
+    static const void *of(const QDomNode &node) { return node.*(&DomNodeId::impl); }
+};
+} // namespace
 
 //----------------------------------------------------------------------------
 // SxeSession
@@ -41,11 +51,18 @@ SxeSession::SxeSession(SxeManager *manager, const Jid &target, const QString &se
 
 {
     setUUIDPrefix();
+
+    flushTimer_.setSingleShot(true);
+    flushTimer_.setInterval(FLUSH_INTERVAL);
+    connect(&flushTimer_, &QTimer::timeout, this, &SxeSession::sendQueuedEdits);
 }
 
 SxeSession::~SxeSession()
 {
     qDebug("destruct SxeSession");
+    // don't lose edits held back by flush(). there is nobody to send them to if the manager is being deleted
+    if (qobject_cast<SxeManager *>(parent()))
+        sendQueuedEdits();
     qDeleteAll(recordByNodeId_);
     recordByNodeId_.clear();
     emit sessionEnded(this);
@@ -62,7 +79,7 @@ void SxeSession::initializeDocument(const QDomDocument &doc)
     const auto &metas = recordByNodeId_.values();
     for (SxeRecord *meta : metas)
         meta->deleteLater();
-    // recordByNode_.clear();
+    recordByNode_.clear();
     recordByNodeId_.clear();
     queuedIncomingEdits_.clear();
     queuedOutgoingEdits_.clear();
@@ -108,13 +125,9 @@ bool SxeSession::processSxe(const QDomElement &sxe, const QString &id)
     if (!id.isEmpty())
         usedSxeIds_ += id;
 
-    // store incoming edits when queueing
+    // store incoming edits when queueing. they are applied as a batch when queueing stops.
+    // (duplicates are already filtered out by the id check above)
     if (queueing_) {
-        // Make sure the element is not already in the queue.
-        for (const IncomingEdit &i : qAsConst(queuedIncomingEdits_))
-            if (i.xml == sxe)
-                return false;
-
         IncomingEdit incoming;
         incoming.id  = id;
         incoming.xml = sxe.cloneNode(true).toElement();
@@ -223,7 +236,7 @@ void SxeSession::stopQueueing()
     queueing_ = false;
 
     // Process queued elements
-    flush();
+    sendQueuedEdits();
 
     if (!queuedIncomingEdits_.isEmpty()) {
         while (!queuedIncomingEdits_.isEmpty()) {
@@ -253,7 +266,11 @@ void SxeSession::stopImporting()
     importing_ = false;
 }
 
-void SxeSession::endSession() { deleteLater(); }
+void SxeSession::endSession()
+{
+    sendQueuedEdits();
+    deleteLater();
+}
 
 const QDomNode SxeSession::insertNodeBefore(const QDomNode &node, const QDomNode &parent, const QDomNode &referenceNode)
 {
@@ -466,6 +483,13 @@ void SxeSession::setNodeValue(const QDomNode &node, const QString &value, int fr
 
 void SxeSession::flush()
 {
+    if (!queuedOutgoingEdits_.isEmpty() && !flushTimer_.isActive())
+        flushTimer_.start();
+}
+
+void SxeSession::sendQueuedEdits()
+{
+    flushTimer_.stop();
     if (queuedOutgoingEdits_.isEmpty())
         return;
 
@@ -499,12 +523,12 @@ QDomNode SxeSession::generateNewNode(const QDomNode node, const QString &parent,
             QString  full  = clone.nodeValue();
             clone.setNodeValue("");
             QDomNode newNode = generateNewNode(clone, parent, primaryWeight);
-            flush();
+            sendQueuedEdits();
 
             // append the value
             for (int i = 0; i < full.length(); i += MAXCHDATA) {
                 setNodeValue(newNode, full.mid(i, MAXCHDATA), i, 0);
-                flush();
+                sendQueuedEdits();
             }
         } else {
             SxeEdit *edit = new SxeNewEdit(rid, node, parent, primaryWeight, false);
@@ -613,47 +637,41 @@ void SxeSession::reposition(const QDomNode &node, bool remote)
         return;
     }
 
-    // get the list of siblings
-    QDomNodeList children = parentNode.childNodes();
+    // Siblings are kept ordered by their records here, so appending is checked first. That's the usual case when
+    // importing a document or drawing.
+    QDomNode last = parentNode.lastChild();
+    if (last == node)
+        last = last.previousSibling();
+    SxeRecord *lastMeta = record(last);
 
     // default to appending
     QDomNode before;
-    bool     insertLast = true;
-    if (children.length() > 0) {
+    if (!last.isNull() && !(lastMeta && !(*meta < *lastMeta))) {
         // find the child with the smallest weight greater than the weight of the node itself
         // if any, insert the node before that node
-        for (int i = 0; i < children.length(); i++) {
-            if (children.item(i) != node) {
-                SxeRecord *siblingMeta = record(children.item(i));
+        for (QDomNode sibling = parentNode.firstChild(); !sibling.isNull(); sibling = sibling.nextSibling()) {
+            if (sibling != node) {
+                SxeRecord *siblingMeta = record(sibling);
                 if (siblingMeta && *meta < *siblingMeta) {
-                    // qDebug() << QString("%1 (pw: %2) is less than %3 (pw:
-                    // %4)").arg(meta->name()).arg(meta->primaryWeight()).arg(siblingMeta->name()).arg(siblingMeta->primaryWeight()).toLatin1();
-                    before     = children.item(i);
-                    insertLast = false;
+                    before = sibling;
                     break;
                 }
             }
         }
     }
 
-    if (insertLast) {
-        // qDebug() << QString("Repositioning '%1' (pw: %2) as
-        // last.").arg(node.nodeName()).arg(meta->primaryWeight()).toLatin1();
+    if (before.isNull())
         parentNode.appendChild(node);
-    } else {
-        // qDebug() << QString("Repositioning '%1' (pw: %2) before '%3' (pw:
-        // %4).").arg(node.nodeName()).arg(meta->primaryWeight()).arg(before.nodeName()).arg(record(before)->primaryWeight()).toLatin1();
+    else
         parentNode.insertBefore(node, before);
-    }
 }
 
-// void SxeSession::addToLookup(const QDomNode &node, bool, const QString &rid) {
-// recordByNode_[node]
-//     = recordByNodeId_[rid];
-// }
-
-void SxeSession::handleNodeToBeAdded(const QDomNode &node, bool remote)
+void SxeSession::handleNodeToBeAdded(const QDomNode &node, bool remote, const QString &rid)
 {
+    SxeRecord *meta = recordByNodeId_.value(rid);
+    if (meta)
+        recordByNode_.insert(DomNodeId::of(node), meta);
+
     emit nodeToBeAdded(node, remote);
     reposition(node, remote);
     emit nodeAdded(node, remote);
@@ -674,14 +692,9 @@ void SxeSession::handleNodeToBeRemoved(const QDomNode &node, bool remote)
 
 void SxeSession::removeRecord(const QDomNode &node)
 {
-    QMutableHashIterator<QString, SxeRecord *> i(recordByNodeId_);
-
-    while (i.hasNext()) {
-        if (node == i.next().value()->node()) {
-            i.remove();
-            return;
-        }
-    }
+    SxeRecord *meta = recordByNode_.take(DomNodeId::of(node));
+    if (meta)
+        recordByNodeId_.remove(meta->rid());
 }
 
 bool SxeSession::removeSmaller(SxeRecord *meta1, SxeRecord *meta2)
@@ -704,7 +717,7 @@ bool SxeSession::removeSmaller(SxeRecord *meta1, SxeRecord *meta2)
 
 void SxeSession::addUsedSxeId(QString id) { usedSxeIds_ += id; }
 
-QList<QString> SxeSession::usedSxeIds() { return usedSxeIds_; }
+QList<QString> SxeSession::usedSxeIds() { return usedSxeIds_.values(); }
 
 void SxeSession::queueOutgoingEdit(SxeEdit *edit)
 {
@@ -724,15 +737,13 @@ SxeRecord *SxeSession::createRecord(const QString &id)
     SxeRecord *m        = new SxeRecord(id);
     recordByNodeId_[id] = m;
 
-    // once the node is actually created, add it to the lookup table
-    // connect(m, SIGNAL(nodeAdded(QDomNode, bool, QString)), SLOT(addToLookup(const QDomNode &, bool, const QString
-    // &)));
-
     // remove the node in case of a conflicting edit
     connect(m, SIGNAL(nodeRemovalRequired(QDomNode)), SLOT(removeNode(QDomNode)));
 
     // reposition and emit public signals as needed when record is changed
-    connect(m, SIGNAL(nodeToBeAdded(QDomNode, bool, QString)), SLOT(handleNodeToBeAdded(const QDomNode &, bool)));
+    // once the node is actually created, it's also added to the lookup table
+    connect(m, SIGNAL(nodeToBeAdded(QDomNode, bool, QString)),
+            SLOT(handleNodeToBeAdded(const QDomNode &, bool, const QString &)));
     connect(m, SIGNAL(nodeToBeMoved(QDomNode, bool)), SLOT(handleNodeToBeMoved(const QDomNode &, bool)));
     connect(m, SIGNAL(nodeToBeRemoved(QDomNode, bool)), SLOT(handleNodeToBeRemoved(const QDomNode &, bool)));
     connect(m, SIGNAL(chdataToBeChanged(QDomNode, bool)), SIGNAL(chdataToBeChanged(const QDomNode &, bool)));
@@ -749,15 +760,7 @@ SxeRecord *SxeSession::record(const QDomNode &node) const
     if (node.isNull())
         return nullptr;
 
-    // go through all the SxeRecord's
-    const auto &metas = recordByNodeId_.values();
-    for (SxeRecord *meta : metas) {
-        // qDebug() << QString("id: %1").arg(meta->rid()).toLatin1();
-        if (node == meta->node())
-            return meta;
-    }
-
-    return nullptr;
+    return recordByNode_.value(DomNodeId::of(node));
 }
 
 void SxeSession::setUUIDPrefix(const QString uuidPrefix)
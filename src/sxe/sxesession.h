@@ -27,6 +27,8 @@
 #include <QList>
 #include <QObject>
 #include <QPointer>
+#include <QSet>
+#include <QTimer>
 
 #define SXENS "http://jabber.org/protocol/sxe"
 /*  ^^^^ make sure corresponds to NS used for parsing in iris/src/xmpp/xmpp-im/types.cpp ^^^^ */
@@ -60,7 +62,7 @@ public:
     SxeSession(SxeManager *manager, const Jid &target, const QString &session, const Jid &ownJid, bool groupChat,
                bool serverSupport, const QList<QString> &features);
     /*! \brief Destructor.
-     *  Emits sessionEnded()
+     *  Sends the edits waiting for the flush interval and emits sessionEnded()
      */
     ~SxeSession();
 
@@ -134,7 +136,9 @@ public slots:
     /*! \brief Sets the value of \a node to \a value. */
     void setNodeValue(const QDomNode &node, const QString &value, int from = -1, int n = 0);
 
-    /*! \brief Sends all queued edits.*/
+    /*! \brief Sends all queued edits.
+     *  Edits flushed in quick succession are coalesced into a single <sxe/> element.
+     */
     void flush();
 
 signals:
@@ -170,14 +174,12 @@ signals:
     void sessionEnded(SxeSession *);
 
 private slots:
-    /*! \brief Adds \a node to the document tree and emits the appropriate public signals. */
-    void handleNodeToBeAdded(const QDomNode &node, bool remote);
+    /*! \brief Adds \a node to the document tree and the lookup tables and emits the appropriate public signals. */
+    void handleNodeToBeAdded(const QDomNode &node, bool remote, const QString &rid);
     /*! \brief Moves \a node in the document tree and emits the appropriate public signals. */
     void handleNodeToBeMoved(const QDomNode &node, bool remote);
     /*! \brief Remove the record entry from the lookup tables and emit the appropriate public signals. */
     void handleNodeToBeRemoved(const QDomNode &node, bool remote);
-    /*! \brief Add a node node to the lookup table. */
-    // void addToLookup(const QDomNode &node, bool, const QString &rid);
 
 private:
     /*! \brief Inserts or moves a node according to it's record (parent and primary-weight). */
@@ -191,6 +193,8 @@ private:
     bool processSxe(const QDomElement &sxe, const QString &id);
     /*! \brief Queues an outgoing edit to be sent when flushed.*/
     void queueOutgoingEdit(SxeEdit *edit);
+    /*! \brief Sends all queued edits right away.*/
+    void sendQueuedEdits();
     /*! \brief Creates the record of node with rid \a id. Returns a pointer to it. */
     SxeRecord *createRecord(const QString &id);
     /*! \brief Returns a pointer to the record of node with rid \a id. */
@@ -223,10 +227,14 @@ private:
 
     /*! \brief Hash used for rid -> SxeRecord* lookups.*/
     QHash<QString, SxeRecord *> recordByNodeId_;
+    /*! \brief Hash used for node -> SxeRecord* lookups. Keyed by the identity of the node.*/
+    QHash<const void *, SxeRecord *> recordByNode_;
     /*! \brief List of queued incoming sxe elements.*/
     QList<IncomingEdit> queuedIncomingEdits_;
     /*! \brief List of queued outgoing sxe elements.*/
     QList<QDomNode> queuedOutgoingEdits_;
+    /*! \brief Sends the queued outgoing edits when flushed.*/
+    QTimer flushTimer_;
     /*! \brief QDomDocument representing the the contents when queueing_ was set true.*/
     QList<SxeEdit *> snapshot_;
     /*! \brief True if the target is a groupchat.*/
@@ -240,7 +248,7 @@ private:
     /*! \brief A list of supported features for the session.*/
     QList<QString> features_;
     /*! \brief Identifiers for the <sxe/> elements that have been processed already.*/
-    QList<QString> usedSxeIds_;
+    QSet<QString> usedSxeIds_;
     /*! \brief A unique id is generated as "uuidPrefix.counter".*/
     QString uuidPrefix_;
     int     uuidMaxPostfix_;
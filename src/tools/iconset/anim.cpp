@@ -23,11 +23,18 @@
 
 //#include <QApplication>
 #include <QBuffer>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QHash>
 #include <QImage>
 #include <QImageReader>
 #include <QObject>
+#include <QPointer>
 #include <QThread>
 #include <QTimer>
+#include <QWindow>
+#include <algorithm>
 
 /**
  * \class Anim
@@ -41,12 +48,102 @@
 
 static QThread *animMainThread = nullptr;
 
+// frame deadlines are rounded up to this, so that anims due at about the same
+//   time advance together on a single wakeup
+#define ANIM_TICK 20 /* ms */
+
+// how often to look again while no window is on screen
+#define ANIM_IDLE_INTERVAL 1000 /* ms */
+
 //! \if _hide_doc_
-class Anim::Private : public QObject, public QSharedData {
+/**
+ * Drives all running anims from one timer instead of one timer per Anim.
+ * While none of the application's windows is exposed (all of them hidden or
+ * minimized) no frames are advanced and nothing gets repainted.
+ */
+class AnimClock : public QObject {
     Q_OBJECT
 public:
-    QTimer *frametimer;
+    static AnimClock *instance()
+    {
+        if (!self) {
+            self = new AnimClock();
+            if (animMainThread && animMainThread != self->thread())
+                self->moveToThread(animMainThread);
+        }
+        return self;
+    }
+
+    // doesn't create the clock, for use from destructors
+    static AnimClock *existing() { return self; }
+
+    void schedule(Anim::Private *anim, int interval)
+    {
+        qint64 at = elapsed.elapsed() + interval;
+        at        = (at + ANIM_TICK - 1) / ANIM_TICK * ANIM_TICK;
+        due.insert(anim, at);
+        if (!ticking && (!timer.isActive() || at < nextTick))
+            reschedule();
+    }
+
+    void unschedule(Anim::Private *anim)
+    {
+        due.remove(anim);
+        if (due.isEmpty() && !ticking)
+            timer.stop();
+    }
+
+    bool isScheduled(Anim::Private *anim) const { return due.contains(anim); }
+
+    quint64 wakeupCount() const { return wakeups; }
+
+private:
+    static AnimClock *self;
+
+    QTimer                         timer;
+    QElapsedTimer                  elapsed;
+    QHash<Anim::Private *, qint64> due;
+    qint64                         nextTick = 0;
+    bool                           ticking  = false;
+    quint64                        wakeups  = 0;
+
+    AnimClock()
+    {
+        elapsed.start();
+        timer.setSingleShot(true);
+        timer.setTimerType(Qt::PreciseTimer);
+        connect(&timer, SIGNAL(timeout()), SLOT(tick()));
+    }
+
+    void reschedule()
+    {
+        if (due.isEmpty()) {
+            timer.stop();
+            return;
+        }
+        nextTick = *std::min_element(due.cbegin(), due.cend());
+        timer.start(int(qMax(qint64(0), nextTick - elapsed.elapsed())));
+    }
 
+    static bool onScreen()
+    {
+        if (!qobject_cast<QGuiApplication *>(QCoreApplication::instance()))
+            return true;
+        const auto windows = QGuiApplication::topLevelWindows();
+        for (QWindow *w : windows) {
+            if (w->isExposed())
+                return true;
+        }
+        return false;
+    }
+
+private slots:
+    void tick();
+};
+
+class Anim::Private : public QObject, public QSharedData {
+    Q_OBJECT
+public:
     bool empty;
     bool paused;
 
@@ -67,12 +164,8 @@ public:
 public:
     void init()
     {
-        frametimer = new QTimer();
-        if (animMainThread && animMainThread != QThread::currentThread()) {
-            frametimer->moveToThread(animMainThread);
+        if (animMainThread && animMainThread != QThread::currentThread())
             moveToThread(animMainThread);
-        }
-        QObject::connect(frametimer, SIGNAL(timeout()), this, SLOT(refresh()));
 
         speed             = 120;
         lasttimerinterval = -1;
@@ -147,14 +240,14 @@ public:
 
     ~Private()
     {
-        if (frametimer)
-            delete frametimer;
+        if (AnimClock::existing())
+            AnimClock::existing()->unschedule(this);
     }
 
     void pause()
     {
         paused = true;
-        frametimer->stop();
+        AnimClock::instance()->unschedule(this);
     }
 
     void unpause()
@@ -174,15 +267,16 @@ public:
 
     void restartTimer()
     {
+        AnimClock *clock = AnimClock::instance();
         if (!paused && speed > 0) {
             int frameperiod = frames[frame].period;
             int i           = frameperiod >= 0 ? frameperiod * 100 / speed : 0;
-            if (i != lasttimerinterval || !frametimer->isActive()) {
+            if (i != lasttimerinterval || !clock->isScheduled(this)) {
                 lasttimerinterval = i;
-                frametimer->start(i);
+                clock->schedule(this, i);
             }
         } else {
-            frametimer->stop();
+            clock->unschedule(this);
         }
     }
 
@@ -208,6 +302,40 @@ public slots:
         restartTimer();
     }
 };
+
+AnimClock *AnimClock::self = nullptr;
+
+void AnimClock::tick()
+{
+    ++wakeups;
+    if (!onScreen()) {
+        // keep the anims subscribed, they'll pick up where they were once
+        //   something is shown again
+        nextTick = elapsed.elapsed() + ANIM_IDLE_INTERVAL;
+        timer.start(ANIM_IDLE_INTERVAL);
+        return;
+    }
+
+    qint64                           now = elapsed.elapsed();
+    QList<QPointer<Anim::Private>> ready;
+    for (auto it = due.begin(); it != due.end();) {
+        if (it.value() <= now) {
+            ready += it.key();
+            it = due.erase(it);
+        } else
+            ++it;
+    }
+
+    // a receiver may delete another anim while we're notifying
+    ticking = true;
+    for (const auto &anim : qAsConst(ready)) {
+        if (anim)
+            anim->refresh();
+    }
+    ticking = false;
+
+    reschedule();
+}
 //! \endif
 
 /**
@@ -374,4 +502,14 @@ void Anim::setMainThread(QThread *thread) { animMainThread = thread; }
  */
 QThread *Anim::mainThread() { return animMainThread; }
 
+/**
+ * Returns how many times the clock shared by all anims has woken up so far.
+ * Meant for diagnostics and tests.
+ */
+quint64 Anim::clockWakeups()
+{
+    AnimClock *clock = AnimClock::existing();
+    return clock ? clock->wakeupCount() : 0;
+}
+
 #include "anim.moc"
@@ -55,6 +55,7 @@ public:
 
     static QThread *mainThread();
     static void     setMainThread(QThread *);
+    static quint64  clockWakeups();
 
     void connectUpdate(QObject *receiver, const char *member);
     void disconnectUpdate(QObject *receiver, const char *member = nullptr);
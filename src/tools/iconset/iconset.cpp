@@ -35,6 +35,7 @@
 #include "svgiconengine.h"
 
 #include <QApplication>
+#include <QAtomicInt>
 #include <QBuffer>
 #include <QCoreApplication>
 #include <QDomDocument>
@@ -42,6 +43,7 @@
 #include <QFileInfo>
 #include <QIcon>
 #include <QIconEngine>
+#include <QImageReader>
 #include <QLocale>
 #include <QObject>
 #include <QPainter>
@@ -52,6 +54,7 @@
 #include <QTextCodec>
 #include <QThread>
 #include <QTimer>
+#include <atomic>
 #ifdef ICONSET_SOUND
 #include <QDataStream>
 #include <qca_basic.h>
@@ -63,6 +66,10 @@ static void moveToMainThread(QObject *obj)
         obj->moveToThread(Anim::mainThread());
 }
 
+// set whenever an iconset which may be registered in IconsetFactory changes.
+// atomic since iconsets may be loaded in worker threads
+static std::atomic_bool iconIndexDirty { true };
+
 //----------------------------------------------------------------------------
 // Impix
 //----------------------------------------------------------------------------
@@ -276,6 +283,9 @@ public:
         anim.reset(from.anim ? new Anim(*from.anim) : nullptr);
         icon           = nullptr;
         activatedCount = from.activatedCount;
+        decodePending  = from.decodePending;
+        decodeAsAnim   = from.decodeAsAnim;
+        stripPending   = from.stripPending;
     }
 
     void connectInstance(PsiIcon *icon)
@@ -295,8 +305,38 @@ signals:
     void iconModified();
 
 public:
+    // image data of icons loaded with PsiIcon::loadFromData() is decoded on first use
+    void ensureDecoded() const
+    {
+        if (decodePending) {
+            const_cast<Private *>(this)->decode();
+        }
+    }
+
+    void decode()
+    {
+        decodePending = false;
+        if (decodeAsAnim) {
+            Anim a(rawData);
+            if (a.numFrames() > 0) {
+                impix = a.frame(0);
+            }
+            if (a.numFrames() > 1) {
+                anim.reset(new Anim(a));
+                if (stripPending) {
+                    anim->stripFirstFrame();
+                }
+            }
+        }
+        stripPending = false;
+        if (impix.isNull()) {
+            impix.loadFromData(rawData);
+        }
+    }
+
     QPixmap pixmap(const QSize &desiredSize = QSize()) const
     {
+        ensureDecoded();
         if (svgRenderer) {
             QSize   sz = desiredSize.isEmpty() ? svgRenderer->defaultSize()
                                                : svgRenderer->defaultSize().scaled(desiredSize, Qt::KeepAspectRatio);
@@ -328,7 +368,10 @@ public:
     std::shared_ptr<QSvgRenderer> svgRenderer;
     QIcon *                       icon = nullptr;
     mutable QByteArray            rawData;
-    bool                          scalable = false;
+    bool                          scalable      = false;
+    bool                          decodePending = false;
+    bool                          decodeAsAnim  = false;
+    bool                          stripPending  = false;
 
     int activatedCount = 0;
     friend class PsiIcon;
@@ -389,7 +432,11 @@ void PsiIcon::detach() { d.detach(); }
 /**
  * Returns \c true when icon contains animation.
  */
-bool PsiIcon::isAnimated() const { return d->anim != nullptr; }
+bool PsiIcon::isAnimated() const
+{
+    d->ensureDecoded();
+    return d->anim != nullptr;
+}
 
 /**
  * Returns QPixmap of current frame.
@@ -401,6 +448,7 @@ QPixmap PsiIcon::pixmap(const QSize &desiredSize) const { return d->pixmap(desir
  */
 QImage PsiIcon::image(const QSize &desiredSize) const
 {
+    d->ensureDecoded();
     if (d->anim) {
         return d->anim->frameImage();
     }
@@ -423,7 +471,11 @@ QImage PsiIcon::image(const QSize &desiredSize) const
  * Returns Impix of first animation frame.
  * \sa setImpix()
  */
-const Impix &PsiIcon::impix() const { return d->impix; }
+const Impix &PsiIcon::impix() const
+{
+    d->ensureDecoded();
+    return d->impix;
+}
 
 /**
  * Returns Impix of current animation frame.
@@ -431,6 +483,7 @@ const Impix &PsiIcon::impix() const { return d->impix; }
  */
 const Impix &PsiIcon::frameImpix() const
 {
+    d->ensureDecoded();
     if (d->anim) {
         return d->anim->frameImpix();
     }
@@ -451,6 +504,7 @@ QIcon PsiIcon::icon() const
         auto eng = new SvgIconEngine(d->name, d->svgRenderer);
         return QIcon(eng);
     }
+    d->ensureDecoded();
     const_cast<Private *>(d.data())->icon = new QIcon(d->impix.pixmap());
     return *d->icon;
 }
@@ -473,6 +527,7 @@ const QByteArray &PsiIcon::raw() const
 
 QSize PsiIcon::size(const QSize &desiredSize) const
 {
+    d->ensureDecoded();
     if (d->scalable) {
         QSize origSize = d->svgRenderer ? d->svgRenderer->defaultSize() : d->impix.size();
         if (!desiredSize.width() && !desiredSize.height())
@@ -502,6 +557,7 @@ void PsiIcon::setImpix(const Impix &impix, bool doDetach)
         detach();
     }
 
+    d->ensureDecoded();
     d->impix = impix;
     if (d->icon) {
         delete d->icon;
@@ -515,7 +571,11 @@ void PsiIcon::setImpix(const Impix &impix, bool doDetach)
 /**
  * Returns pointer to Anim object, or \a 0 if PsiIcon doesn't contain an animation.
  */
-const Anim *PsiIcon::anim() const { return d->anim.get(); }
+const Anim *PsiIcon::anim() const
+{
+    d->ensureDecoded();
+    return d->anim.get();
+}
 
 /**
  * Sets the animation for icon to \a anim. Also sets Impix to be the first frame of animation.
@@ -528,6 +588,7 @@ void PsiIcon::setAnim(const Anim &anim, bool doDetach)
         detach();
     }
 
+    d->ensureDecoded();
     d->anim.reset(new Anim(anim));
 
     if (d->anim->numFrames() > 0) {
@@ -557,6 +618,7 @@ void PsiIcon::removeAnim(bool doDetach)
         detach();
     }
 
+    d->ensureDecoded();
     if (!d->anim) {
         return;
     }
@@ -576,6 +638,7 @@ void PsiIcon::removeAnim(bool doDetach)
  */
 int PsiIcon::frameNumber() const
 {
+    d->ensureDecoded();
     if (d->anim) {
         return d->anim->frameNumber();
     }
@@ -702,6 +765,9 @@ bool PsiIcon::blockSignals(bool b) { return d->blockSignals(b); }
 /**
  * Initializes PsiIcon's Impix (or Anim, if \a isAnim equals \c true).
  * Iconset::load uses this function.
+ *
+ * Raster images are only validated here by their header and decoded
+ * when the icon is actually used for the first time.
  */
 bool PsiIcon::loadFromData(const QString &mime, const QByteArray &ba, bool isAnim, bool isScalable)
 {
@@ -710,10 +776,24 @@ bool PsiIcon::loadFromData(const QString &mime, const QByteArray &ba, bool isAni
         return ret;
 
     detach();
-    d->rawData     = ba;
-    d->scalable    = isScalable;
-    d->svgRenderer = nullptr;
-    if (d->scalable) {
+    d->rawData       = ba;
+    d->scalable      = isScalable;
+    d->svgRenderer   = nullptr;
+    d->decodePending = false;
+    d->stripPending  = false;
+    if (!d->scalable) {
+        QBuffer buffer(&d->rawData);
+        buffer.open(QIODevice::ReadOnly);
+        if (QImageReader(&buffer).canRead()) {
+            d->impix         = Impix();
+            d->decodePending = true;
+            d->decodeAsAnim  = isAnim;
+            d->anim.reset();
+            delete d->icon;
+            d->icon = nullptr;
+            ret     = true;
+        }
+    } else {
         d->svgRenderer = std::make_shared<QSvgRenderer>(ba);
         if (!d->svgRenderer->isValid()) {
             d->svgRenderer.reset();
@@ -722,7 +802,7 @@ bool PsiIcon::loadFromData(const QString &mime, const QByteArray &ba, bool isAni
     }
     if (d->svgRenderer) {
         ret = true;
-    } else {
+    } else if (!ret) {
         if (isAnim) {
             Anim *anim = new Anim(ba);
             setAnim(*anim);
@@ -754,6 +834,7 @@ bool PsiIcon::loadFromData(const QString &mime, const QByteArray &ba, bool isAni
  */
 void PsiIcon::activated(bool playSound)
 {
+    d->ensureDecoded();
     d->activatedCount++;
 
 #ifdef ICONSET_SOUND
@@ -805,7 +886,9 @@ void PsiIcon::stripFirstAnimFrame()
 {
     detach();
 
-    if (d->anim) {
+    if (d->decodePending) {
+        d->stripPending = d->decodeAsAnim;
+    } else if (d->anim) {
         d->anim->stripFirstFrame();
     }
 }
@@ -827,7 +910,10 @@ void PsiIcon::stripFirstAnimFrame()
 //! \if _hide_doc_
 class IconsetFactoryPrivate : public QObject {
 private:
-    IconsetFactoryPrivate() : QObject(QCoreApplication::instance()), iconsets_(nullptr), emptyPixmap_(nullptr) { }
+    IconsetFactoryPrivate() : QObject(QCoreApplication::instance()), iconsets_(nullptr), emptyPixmap_(nullptr)
+    {
+        iconIndexDirty = true;
+    }
 
     ~IconsetFactoryPrivate()
     {
@@ -848,6 +934,11 @@ private:
     QList<Iconset *> *            iconsets_;
     mutable QPixmap *             emptyPixmap_;
 
+    // name -> icon from the first registered iconset having it. rebuilt on demand when iconIndexDirty is set
+    mutable QHash<QString, const PsiIcon *> index_;
+
+    void updateIndex() const;
+
 public:
     const QPixmap &emptyPixmap() const
     {
@@ -903,6 +994,7 @@ void IconsetFactoryPrivate::registerIconset(const Iconset *i)
 
     if (!iconsets_->contains(const_cast<Iconset *>(i))) {
         iconsets_->append(const_cast<Iconset *>(i));
+        iconIndexDirty = true;
     }
 }
 
@@ -910,26 +1002,16 @@ void IconsetFactoryPrivate::unregisterIconset(const Iconset *i)
 {
     if (iconsets_ && iconsets_->contains(const_cast<Iconset *>(i))) {
         iconsets_->removeAll(const_cast<Iconset *>(i));
+        iconIndexDirty = true;
     }
 }
 
 const PsiIcon *IconsetFactoryPrivate::icon(const QString &name) const
 {
-    if (!iconsets_) {
-        return nullptr;
+    if (iconIndexDirty.exchange(false)) {
+        updateIndex();
     }
-
-    const PsiIcon *out = nullptr;
-    for (const Iconset *const iconset : qAsConst(*iconsets_)) {
-        if (iconset) {
-            out = iconset->icon(name);
-        }
-
-        if (out) {
-            break;
-        }
-    }
-    return out;
+    return index_.value(name);
 }
 
 void IconsetFactory::reset() { IconsetFactoryPrivate::reset(); }
@@ -1160,7 +1242,7 @@ public:
         }
     }
 
-    static int icon_counter; // used to give unique names to icons
+    static QAtomicInt icon_counter; // used to give unique names to icons
 
     // will return 'true' when icon is loaded ok
     bool loadKdeEmoticon(const QDomElement &emot, const QString &dir, QSize &size)
@@ -1253,7 +1335,7 @@ public:
         QList<PsiIcon::IconText> text;
         QHash<QString, QString>  graphic, sound, object; // mime => filename
 
-        QString name       = QString::asprintf("icon_%04d", icon_counter++);
+        QString name       = QString::asprintf("icon_%04d", icon_counter.fetchAndAddRelaxed(1));
         bool    isAnimated = false;
         bool    isImage    = false;
         bool    isScalable = false;
@@ -1500,7 +1582,26 @@ public:
 };
 //! \endif
 
-int Iconset::Private::icon_counter = 0;
+QAtomicInt Iconset::Private::icon_counter = 0;
+
+void IconsetFactoryPrivate::updateIndex() const
+{
+    index_.clear();
+    if (!iconsets_) {
+        return;
+    }
+
+    for (const Iconset *const iconset : qAsConst(*iconsets_)) {
+        if (!iconset) {
+            continue;
+        }
+        for (auto it = iconset->d->dict.constBegin(); it != iconset->d->dict.constEnd(); ++it) {
+            if (!index_.contains(it.key())) { // earlier registered iconsets win
+                index_.insert(it.key(), it.value());
+            }
+        }
+    }
+}
 
 // static int iconset_counter = 0;
 
@@ -1534,7 +1635,8 @@ Iconset::~Iconset() { IconsetFactoryPrivate::instance()->unregisterIconset(this)
  */
 Iconset &Iconset::operator=(const Iconset &from)
 {
-    d = from.d;
+    d              = from.d;
+    iconIndexDirty = true;
 
     return *this;
 }
@@ -1547,7 +1649,12 @@ Iconset Iconset::copy() const
     return is;
 }
 
-void Iconset::detach() { d.detach(); }
+void Iconset::detach()
+{
+    d.detach();
+    // icons may be about to change, so lookups by name must not use stale pointers
+    iconIndexDirty = true;
+}
 
 /**
  * Appends icons from Iconset \a from to this Iconset.
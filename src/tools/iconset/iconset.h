@@ -232,6 +232,8 @@ public:
 private:
     class Private;
     QSharedDataPointer<Private> d;
+
+    friend class IconsetFactoryPrivate;
 };
 
 class IconsetFactory {
@@ -1,8 +1,18 @@
 #include "anim.h"
 #include "iconset.h"
 
+#include <QWindow>
 #include <QtTest/QtTest>
 
+class UpdateCounter : public QObject {
+    Q_OBJECT
+public:
+    int updates = 0;
+
+public slots:
+    void count() { updates++; }
+};
+
 class TestIconset : public QObject {
     Q_OBJECT
 private:
@@ -113,6 +123,45 @@ private slots:
         delete copy1;
     }
 
+    void testAnimClock()
+    {
+        const PsiIcon *chat = IconsetFactory::iconPtr("psi/chat");
+        QVERIFY(chat != 0);
+        QVERIFY(chat->anim() != 0);
+
+        UpdateCounter counter;
+        QList<Anim *> anims;
+        for (int i = 0; i < 50; i++) {
+            Anim *anim = new Anim(chat->anim()->copy());
+            anim->connectUpdate(&counter, SLOT(count()));
+            anim->unpause();
+            anims << anim;
+        }
+
+        // with a window on screen all the anims advance together on shared wakeups
+        QWindow window;
+        window.show();
+        QVERIFY(QTest::qWaitForWindowExposed(&window));
+        quint64 wakeups = Anim::clockWakeups();
+        QTest::qWait(1000);
+        wakeups = Anim::clockWakeups() - wakeups;
+        QVERIFY(wakeups > 0);
+        QVERIFY(counter.updates >= anims.count());
+        QVERIFY(wakeups * 10 < quint64(counter.updates));
+
+        // with nothing on screen nothing is advanced and the clock only checks now and then
+        window.hide();
+        QTRY_VERIFY(!window.isExposed());
+        QTest::qWait(100);
+        counter.updates = 0;
+        wakeups         = Anim::clockWakeups();
+        QTest::qWait(2500);
+        QCOMPARE(counter.updates, 0);
+        QVERIFY(Anim::clockWakeups() - wakeups <= 4);
+
+        qDeleteAll(anims);
+    }
+
     void testIconStripping()
     {
         const PsiIcon *chat = IconsetFactory::iconPtr("psi/chat");
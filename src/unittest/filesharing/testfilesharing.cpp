@@ -0,0 +1,158 @@
+#include "filesharingitem.h"
+#include "filesharingmanager.h"
+#include "xmpp_hash.h"
+
+#include <QCryptographicHash>
+#include <QTemporaryDir>
+#include <QUuid>
+#include <QtTest/QtTest>
+
+using namespace XMPP;
+
+class TestFileSharing : public QObject {
+    Q_OBJECT
+private:
+    FileSharingManager *manager;
+    QTemporaryDir *     dir;
+
+    QString writeFile(const QString &name, const QByteArray &data)
+    {
+        QFile f(dir->filePath(name));
+        f.open(QIODevice::WriteOnly);
+        f.write(data);
+        return f.fileName();
+    }
+
+    static void waitHashed(FileSharingItem *item)
+    {
+        if (item->isHashing()) {
+            QSignalSpy finished(item, &FileSharingItem::hashingFinished);
+            QVERIFY(finished.wait(10000));
+        }
+    }
+
+private slots:
+    void init()
+    {
+        manager = new FileSharingManager;
+        dir     = new QTemporaryDir;
+    }
+
+    void cleanup()
+    {
+        delete manager;
+        delete dir;
+    }
+
+    void hashesInBackground()
+    {
+        // a few chunks, so the worker reports progress more than once
+        QByteArray data(3 * 1024 * 1024 + 17, 'x');
+        auto       fileName = writeFile("data.bin", data);
+
+        auto items = manager->fromFilesList(QStringList { fileName }, nullptr);
+        QCOMPARE(items.size(), 1);
+        auto item = items.first();
+        QVERIFY(item->isHashing());
+        QVERIFY(item->sums().isEmpty());
+
+        QSignalSpy progress(item, &FileSharingItem::hashingProgress);
+        waitHashed(item);
+        QVERIFY(!item->isHashing());
+        QVERIFY(!progress.isEmpty());
+
+        auto expected = Hash::from(Hash::Sha1, data);
+        QCOMPARE(item->sums().size(), 1);
+        QVERIFY(item->sums().first() == expected);
+        QCOMPARE(item->sums().first().data(), QCryptographicHash::hash(data, QCryptographicHash::Sha1));
+        // looked up by content hash only once hashing is done
+        QCOMPARE(manager->item(expected), item);
+        QVERIFY(item->log().isEmpty());
+    }
+
+    void sniffsMimeTypeFromContent()
+    {
+        // the extension lies, the content wins once hashed
+        auto fileName = writeFile("picture.txt", QByteArray::fromHex("89504e470d0a1a0a0000000d49484452"));
+        auto item     = manager->fromFilesList(QStringList { fileName }, nullptr).value(0);
+        QVERIFY(item);
+        QCOMPARE(item->mimeType(), QString("text/plain"));
+        waitHashed(item);
+        QCOMPARE(item->mimeType(), QString("image/png"));
+    }
+
+    void emptyFile()
+    {
+        auto item = manager->fromFilesList(QStringList { writeFile("empty", QByteArray()) }, nullptr).value(0);
+        QVERIFY(item);
+        waitHashed(item);
+        QCOMPARE(item->sums().size(), 1);
+        QVERIFY(item->sums().first() == Hash::from(Hash::Sha1, QByteArray()));
+    }
+
+    void unreadableFile()
+    {
+        auto item = new FileSharingItem(dir->filePath("missing"), nullptr, manager);
+        QSignalSpy logChanged(item, &FileSharingItem::logChanged);
+        waitHashed(item);
+        QVERIFY(item->sums().isEmpty());
+        QCOMPARE(logChanged.count(), 1);
+        QCOMPARE(item->log().size(), 1);
+    }
+
+    void publishBeforeHashingFinishes()
+    {
+        auto       item = new FileSharingItem(dir->filePath("missing"), nullptr, manager);
+        QSignalSpy published(item, &FileSharingItem::publishFinished);
+        QVERIFY(item->isHashing());
+
+        // both calls wait for the hash and resolve into a single publish
+        item->publish(Jid("me@example.org/psi"));
+        item->publish(Jid("me@example.org/psi"));
+        QCOMPARE(published.count(), 0);
+
+        waitHashed(item);
+        QCOMPARE(published.count(), 1);
+
+        // nothing stays connected for a later publish
+        QCoreApplication::processEvents();
+        QCOMPARE(published.count(), 1);
+    }
+
+    void thumbnailId()
+    {
+        auto a = Hash::from(Hash::Sha1, QByteArray("a"));
+        auto b = Hash::from(Hash::Sha1, QByteArray("b"));
+
+        auto id = FileSharingManager::thumbnailId(a, QSize(64, 64));
+        QVERIFY(id.isValid());
+        QVERIFY(id == FileSharingManager::thumbnailId(a, QSize(64, 64)));
+        QVERIFY(!(id == a));
+        QVERIFY(!(id == FileSharingManager::thumbnailId(b, QSize(64, 64))));
+        QVERIFY(!(id == FileSharingManager::thumbnailId(a, QSize(64, 32))));
+        QVERIFY(!(id == FileSharingManager::thumbnailId(a, QSize(32, 64))));
+        // 1x164 and 11x64 must not collide
+        QVERIFY(!(FileSharingManager::thumbnailId(a, QSize(1, 164))
+                  == FileSharingManager::thumbnailId(a, QSize(11, 64))));
+    }
+
+    void thumbnailCache()
+    {
+        // the cache outlives the test run, so never reuse a source
+        auto   source = Hash::from(Hash::Sha1, QUuid::createUuid().toByteArray());
+        QImage thumb(16, 8, QImage::Format_ARGB32);
+        thumb.fill(Qt::red);
+
+        QVERIFY(manager->cachedThumbnail(source, thumb.size()).isNull());
+        manager->cacheThumbnail(source, thumb.size(), thumb);
+
+        auto cached = manager->cachedThumbnail(source, thumb.size());
+        QCOMPARE(cached.size(), thumb.size());
+        QCOMPARE(cached.pixel(3, 3), thumb.pixel(3, 3));
+        // another size of the same source is a separate entry
+        QVERIFY(manager->cachedThumbnail(source, QSize(8, 16)).isNull());
+    }
+};
+
+QTEST_MAIN(TestFileSharing)
+#include "testfilesharing.moc"
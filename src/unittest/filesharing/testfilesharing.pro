@@ -0,0 +1,4 @@
+TARGET = testfilesharing
+SOURCES += testfilesharing.cpp
+
+include(../half_of_psi.pri)
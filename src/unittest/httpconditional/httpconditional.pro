@@ -0,0 +1,15 @@
+# unittest helpers
+TARGET = httpconditional
+CONFIG += unittest
+TESTBASEDIR = ../../../unittest
+include($$TESTBASEDIR/unittest.pri)
+
+INCLUDEPATH += ../..
+DEPENDPATH  += ../..
+
+SOURCES += \
+    testhttpconditional.cpp \
+    ../../httpconditional.cpp
+
+HEADERS += \
+    ../../httpconditional.h
@@ -0,0 +1,68 @@
+#include "httpconditional.h"
+
+#include <QtTest/QtTest>
+
+using namespace HttpConditional;
+
+class TestHttpConditional : public QObject {
+    Q_OBJECT
+
+private:
+    const QByteArray tag = "\"0a1b2c\"";
+    const QDateTime  modified { QDate(2019, 11, 6), QTime(8, 49, 37), Qt::UTC };
+
+private slots:
+    void testDate()
+    {
+        QCOMPARE(formatDate(modified), QByteArray("Wed, 06 Nov 2019 08:49:37 GMT"));
+        QCOMPARE(parseDate("Wed, 06 Nov 2019 08:49:37 GMT"), modified);
+        // qhttp hands us lower-cased values
+        QCOMPARE(parseDate("wed, 06 nov 2019 08:49:37 gmt"), modified);
+        QVERIFY(!parseDate("yesterday").isValid());
+    }
+
+    void testIfNoneMatch()
+    {
+        QVERIFY(isNotModified(tag, QByteArray(), tag, QDateTime()));
+        QVERIFY(isNotModified("\"ffff\", " + tag, QByteArray(), tag, QDateTime()));
+        QVERIFY(isNotModified("w/" + tag, QByteArray(), tag, QDateTime()));
+        QVERIFY(isNotModified("*", QByteArray(), tag, QDateTime()));
+        QVERIFY(!isNotModified("\"ffff\"", QByteArray(), tag, QDateTime()));
+        QVERIFY(!isNotModified("*", QByteArray(), QByteArray(), QDateTime())); // no tag, nothing to match
+    }
+
+    void testIfModifiedSince()
+    {
+        QVERIFY(isNotModified(QByteArray(), "wed, 06 nov 2019 08:49:37 gmt", tag, modified));
+        QVERIFY(isNotModified(QByteArray(), "thu, 07 nov 2019 00:00:00 gmt", tag, modified));
+        QVERIFY(!isNotModified(QByteArray(), "tue, 05 nov 2019 00:00:00 gmt", tag, modified));
+        QVERIFY(!isNotModified(QByteArray(), "garbage", tag, modified));
+        QVERIFY(!isNotModified(QByteArray(), "thu, 07 nov 2019 00:00:00 gmt", tag, QDateTime()));
+
+        // a mismatching tag wins over a fresh date
+        QVERIFY(!isNotModified("\"ffff\"", "thu, 07 nov 2019 00:00:00 gmt", tag, modified));
+    }
+
+    void testIfRange()
+    {
+        QVERIFY(isRangeValid(QByteArray(), tag));
+        QVERIFY(isRangeValid(tag, tag));
+        QVERIFY(!isRangeValid("\"ffff\"", tag));
+        QVERIFY(!isRangeValid("w/" + tag, tag)); // weak tags can't validate a range
+        QVERIFY(!isRangeValid("wed, 06 nov 2019 08:49:37 gmt", tag));
+        QVERIFY(!isRangeValid(tag, QByteArray()));
+    }
+
+    void testHead()
+    {
+        QVERIFY(hasBody("GET", 200));
+        QVERIFY(hasBody("GET", 206));
+        QVERIFY(!hasBody("HEAD", 200));
+        QVERIFY(!hasBody("HEAD", 206));
+        QVERIFY(!hasBody("GET", 304));
+        QVERIFY(!hasBody("GET", 204));
+    }
+};
+
+QTEST_MAIN(TestHttpConditional)
+#include "testhttpconditional.moc"
@@ -0,0 +1,123 @@
+#include "sxe/sxemanager.h"
+#include "sxe/sxesession.h"
+#include "xmpp_client.h"
+
+#include <QPointer>
+#include <QtTest/QtTest>
+
+class TestSxeSession : public QObject {
+    Q_OBJECT
+private:
+    XMPP::Client *       client;
+    SxeManager *         manager;
+    QPointer<SxeSession> session;
+    QList<QDomElement>   sent;
+    QDomDocument         scratch;
+
+    QDomElement root() const { return session->document().documentElement(); }
+
+    QDomNode insert(const QString &tagName, const QDomNode &after = QDomNode())
+    {
+        return session->insertNodeAfter(scratch.createElement(tagName), root(), after);
+    }
+
+    QStringList childNames() const
+    {
+        QStringList  names;
+        QDomNodeList children = root().childNodes();
+        for (int i = 0; i < children.count(); i++)
+            names << children.at(i).nodeName();
+        return names;
+    }
+
+private slots:
+    void init()
+    {
+        client  = new XMPP::Client;
+        manager = new SxeManager(client, nullptr);
+        // not created through the manager, so nothing goes out to the network
+        session = new SxeSession(manager, XMPP::Jid("peer@example.org/wb"), "s1", XMPP::Jid("me@example.org/psi"),
+                                 false, false, QList<QString>());
+        connect(session, &SxeSession::newSxeElement, this, [this](const QDomElement &sxe) { sent << sxe; });
+
+        QDomDocument doc;
+        doc.setContent(QString("<svg/>"));
+        session->initializeDocument(doc);
+        sent.clear();
+    }
+
+    void cleanup()
+    {
+        delete session;
+        delete manager;
+        delete client;
+    }
+
+    void testRecordLookup()
+    {
+        QDomNode a = insert("a");
+        QDomNode b = insert("b", a);
+        QVERIFY(!a.isNull() && !b.isNull());
+        // the weight of c is taken from the records of a and b
+        insert("c", a);
+        QCOMPARE(childNames(), QStringList({ "a", "c", "b" }));
+
+        // setting the value of the new attribute needs the record of the attribute node
+        session->setAttribute(b, "x", "1");
+        session->setAttribute(b, "x", "2");
+        QCOMPARE(b.toElement().attribute("x"), QString("2"));
+
+        session->removeNode(b);
+        QCOMPARE(childNames(), QStringList({ "a", "c" }));
+        QTRY_COMPARE(sent.size(), 1);
+        // new a, b, c, x; set x; remove x, b
+        QCOMPARE(sent.first().childNodes().count(), 7);
+
+        // the removed nodes have no records left, so they produce no edits
+        session->setAttribute(b, "x", "3");
+        session->removeNode(b);
+        session->flush();
+        QTest::qWait(200);
+        QCOMPARE(sent.size(), 1);
+
+        // while the remaining ones still resolve
+        insert("d", a);
+        QCOMPARE(childNames(), QStringList({ "a", "d", "c" }));
+    }
+
+    void testFlushCoalesces()
+    {
+        QDomNode a = insert("a");
+        session->flush();
+        session->setAttribute(a, "x", "1");
+        session->flush();
+        session->setAttribute(a, "y", "1");
+        session->flush();
+        QCOMPARE(sent.size(), 0);
+
+        QTRY_COMPARE(sent.size(), 1);
+        QCOMPARE(sent.first().childNodes().count(), 3);
+        QTest::qWait(200);
+        QCOMPARE(sent.size(), 1);
+    }
+
+    void testDeleteSendsQueued()
+    {
+        insert("a");
+        session->flush();
+        delete session;
+        QCOMPARE(sent.size(), 1);
+        QCOMPARE(sent.first().childNodes().count(), 1);
+    }
+
+    void testEndSessionSendsQueued()
+    {
+        insert("a");
+        session->flush();
+        session->endSession();
+        QCOMPARE(sent.size(), 1);
+    }
+};
+
+QTEST_MAIN(TestSxeSession)
+#include "testsxesession.moc"
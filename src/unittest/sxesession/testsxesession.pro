@@ -0,0 +1,4 @@
+TARGET = testsxesession
+SOURCES += testsxesession.cpp
+
+include(../half_of_psi.pri)
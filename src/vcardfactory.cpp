@@ -21,26 +21,26 @@
 
 #include "applicationinfo.h"
 #include "jidutil.h"
-#include "profiles.h"
 #include "psiaccount.h"
 #include "xmpp_client.h"
 #include "xmpp_tasks.h"
 #include "xmpp_vcard.h"
 
 #include <QApplication>
+#include <QCryptographicHash>
 #include <QDir>
 #include <QDomDocument>
 #include <QFile>
 #include <QMap>
 #include <QObject>
-#include <QTextStream>
+#include <QSaveFile>
 
 #include <functional>
 
 /**
  * \brief Factory for retrieving and changing VCards.
  */
-VCardFactory::VCardFactory() : QObject(qApp), dictSize_(5) { }
+VCardFactory::VCardFactory() : QObject(qApp), dictSize_(100) { }
 
 /**
  * \brief Destroys all cached VCards.
@@ -112,25 +112,35 @@ void VCardFactory::mucTaskFinished()
     }
 }
 
-void VCardFactory::saveVCard(const Jid &j, const VCard &vcard, bool notifyPhoto)
+QString VCardFactory::vcardFileName(const QString &bareJid) const
 {
-    checkLimit(j.bare(), vcard);
+    return ApplicationInfo::vCardDir() + '/' + JIDUtil::encode(bareJid).toLower() + ".xml";
+}
 
-    // save vCard to disk
+void VCardFactory::saveVCard(const Jid &j, const VCard &vcard, bool notifyPhoto)
+{
+    const QString bare = j.bare();
+    checkLimit(bare, vcard);
 
-    // ensure that there's a vcard directory to save into
-    QDir p(pathToProfile(activeProfile, ApplicationInfo::CacheLocation));
-    QDir v(pathToProfile(activeProfile, ApplicationInfo::CacheLocation) + "/vcard");
-    if (!v.exists())
-        p.mkdir("vcard");
+    // save vCard to disk, unless it's exactly what is there already. servers
+    // and contacts resend unchanged vCards all the time
 
-    QFile file(ApplicationInfo::vCardDir() + '/' + JIDUtil::encode(j.bare()).toLower() + ".xml");
-    file.open(QIODevice::WriteOnly);
-    QTextStream out(&file);
-    out.setCodec("UTF-8");
     QDomDocument doc;
     doc.appendChild(vcard.toXml(&doc));
-    out << doc.toString(4);
+    QByteArray    data     = doc.toString(4).toUtf8();
+    QByteArray    hash     = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    const QString fileName = vcardFileName(bare);
+    if (fileHashes_.value(bare) != hash || !QFile::exists(fileName)) { // the cleaner plugin may have removed it
+        // ensure that there's a vcard directory to save into
+        QDir().mkpath(ApplicationInfo::vCardDir());
+
+        QSaveFile file(fileName);
+        if (file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit()) {
+            fileHashes_.insert(bare, hash);
+            missingFiles_.remove(bare);
+        } else
+            qWarning("VCardFactory: failed to save vCard for %s", qPrintable(bare));
+    }
 
     Jid  jid = j;
     emit vcardChanged(jid);
@@ -158,24 +168,39 @@ const VCard VCardFactory::mucVcard(const Jid &j) const
  */
 VCard VCardFactory::vcard(const Jid &j)
 {
+    const QString bare = j.bare();
+
     // first, try to get vCard from runtime cache
-    if (vcardDict_.contains(j.bare())) {
-        return vcardDict_[j.bare()];
+    auto it = vcardDict_.constFind(bare);
+    if (it != vcardDict_.constEnd()) {
+        VCard vcard = *it;
+        if (vcardList_.first() != bare) {
+            vcardList_.removeOne(bare);
+            vcardList_.push_front(bare);
+        }
+        return vcard;
     }
 
-    // then try to load from cache on disk
-    QFile file(ApplicationInfo::vCardDir() + '/' + JIDUtil::encode(j.bare()).toLower() + ".xml");
-    file.open(QIODevice::ReadOnly);
-    QDomDocument doc;
+    // tooltips and the roster ask about contacts without a vCard over and over
+    if (missingFiles_.contains(bare))
+        return VCard();
 
-    if (doc.setContent(&file, false)) {
-        VCard vcard = VCard::fromXml(doc.documentElement());
-        if (!vcard.isNull()) {
-            checkLimit(j.bare(), vcard);
-            return vcard;
+    // then try to load from cache on disk
+    QFile file(vcardFileName(bare));
+    if (file.open(QIODevice::ReadOnly)) {
+        QByteArray   data = file.readAll();
+        QDomDocument doc;
+        if (doc.setContent(data, false)) {
+            VCard vcard = VCard::fromXml(doc.documentElement());
+            if (!vcard.isNull()) {
+                fileHashes_.insert(bare, QCryptographicHash::hash(data, QCryptographicHash::Sha1));
+                checkLimit(bare, vcard);
+                return vcard;
+            }
         }
     }
 
+    missingFiles_.insert(bare);
     return VCard();
 }
 
@@ -23,6 +23,7 @@
 #include <QHash>
 #include <QMap>
 #include <QObject>
+#include <QSet>
 #include <QStringList>
 #include <functional>
 
@@ -75,7 +76,11 @@ private:
     QMap<QString, QQueue<QString>>
         lastMucVcards_; // to limit the hash above. this one keeps ordered resource. mucBareJid => resource_list
 
-    void saveVCard(const Jid &, const VCard &, bool notifyPhoto);
+    QHash<QString, QByteArray> fileHashes_;   // bareJid => sha1 of what's in its file, if we read or wrote it
+    QSet<QString>              missingFiles_; // bareJids known to have no usable file
+
+    QString vcardFileName(const QString &bareJid) const;
+    void    saveVCard(const Jid &, const VCard &, bool notifyPhoto);
 };
 
 #endif // VCARDFACTORY_H
@@ -7786,161 +7786,51 @@ static std::vector<EmojiRegistry::Group> db = {
     }
 };
 
-static std::map<quint32, quint32> ranges = {
-    {35, 35},
-    {42, 42},
-    {48, 57},
-    {169, 169},
-    {174, 174},
-    {8252, 8252},
-    {8265, 8265},
-    {8482, 8482},
-    {8505, 8505},
-    {8596, 8601},
-    {8617, 8618},
-    {8986, 8987},
-    {9000, 9000},
-    {9167, 9167},
-    {9193, 9203},
-    {9208, 9210},
-    {9410, 9410},
-    {9642, 9643},
-    {9654, 9654},
-    {9664, 9664},
-    {9723, 9726},
-    {9728, 9732},
-    {9742, 9742},
-    {9745, 9745},
-    {9748, 9749},
-    {9752, 9752},
-    {9757, 9757},
-    {9760, 9760},
-    {9762, 9763},
-    {9766, 9766},
-    {9770, 9770},
-    {9774, 9775},
-    {9784, 9786},
-    {9792, 9792},
-    {9794, 9794},
-    {9800, 9811},
-    {9823, 9824},
-    {9827, 9827},
-    {9829, 9830},
-    {9832, 9832},
-    {9851, 9851},
-    {9854, 9855},
-    {9874, 9879},
-    {9881, 9881},
-    {9883, 9884},
-    {9888, 9889},
-    {9895, 9895},
-    {9898, 9899},
-    {9904, 9905},
-    {9917, 9918},
-    {9924, 9925},
-    {9928, 9928},
-    {9934, 9935},
-    {9937, 9937},
-    {9939, 9940},
-    {9961, 9962},
-    {9968, 9973},
-    {9975, 9978},
-    {9981, 9981},
-    {9986, 9986},
-    {9989, 9989},
-    {9992, 9997},
-    {9999, 9999},
-    {10002, 10002},
-    {10004, 10004},
-    {10006, 10006},
-    {10013, 10013},
-    {10017, 10017},
-    {10024, 10024},
-    {10035, 10036},
-    {10052, 10052},
-    {10055, 10055},
-    {10060, 10060},
-    {10062, 10062},
-    {10067, 10069},
-    {10071, 10071},
-    {10083, 10084},
-    {10133, 10135},
-    {10145, 10145},
-    {10160, 10160},
-    {10175, 10175},
-    {10548, 10549},
-    {11013, 11015},
-    {11035, 11036},
-    {11088, 11088},
-    {11093, 11093},
-    {12336, 12336},
-    {12349, 12349},
-    {12951, 12951},
-    {12953, 12953},
-    {126980, 126980},
-    {127183, 127183},
-    {127344, 127345},
-    {127358, 127359},
-    {127374, 127374},
-    {127377, 127386},
-    {127462, 127487},
-    {127489, 127490},
-    {127514, 127514},
-    {127535, 127535},
-    {127538, 127546},
-    {127568, 127569},
-    {127744, 127777},
-    {127780, 127891},
-    {127894, 127895},
-    {127897, 127899},
-    {127902, 127984},
-    {127987, 127989},
-    {127991, 127994},
-    {128000, 128253},
-    {128255, 128317},
-    {128329, 128334},
-    {128336, 128359},
-    {128367, 128368},
-    {128371, 128378},
-    {128391, 128391},
-    {128394, 128397},
-    {128400, 128400},
-    {128405, 128406},
-    {128420, 128421},
-    {128424, 128424},
-    {128433, 128434},
-    {128444, 128444},
-    {128450, 128452},
-    {128465, 128467},
-    {128476, 128478},
-    {128481, 128481},
-    {128483, 128483},
-    {128488, 128488},
-    {128495, 128495},
-    {128499, 128499},
-    {128506, 128591},
-    {128640, 128709},
-    {128715, 128722},
-    {128725, 128727},
-    {128736, 128741},
-    {128745, 128745},
-    {128747, 128748},
-    {128752, 128752},
-    {128755, 128764},
-    {128992, 129003},
-    {129292, 129338},
-    {129340, 129349},
-    {129351, 129400},
-    {129402, 129455},
-    {129460, 129483},
-    {129485, 129535},
-    {129648, 129652},
-    {129656, 129658},
-    {129664, 129670},
-    {129680, 129704},
-    {129712, 129718},
-    {129728, 129730},
-    {129744, 129750}
+// two-level bitmap of code points an emoji can start with. the code point's
+// high bits select a block (0 - none of the block's code points does), the low
+// 8 bits select a bit in that block
+static const quint8 emojiStartBlocks[] = {
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    2, 3, 0, 4, 5, 6, 7, 8, 0, 9, 0, 10, 0, 0, 0, 0, 11, 0, 12, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 13, 14, 15, 16, 17, 18, 19, 20, 0, 21, 22
+};
+
+static const quint32 emojiStartBits[][8] = {
+    {0x00000000, 0x03ff0408, 0x00000000, 0x00000000, 0x00000000, 0x00004200, 0x00000000, 0x00000000},
+    {0x00000000, 0x10000000, 0x00000200, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000},
+    {0x00000000, 0x02000004, 0x00000000, 0x00000000, 0x03f00000, 0x00000600, 0x00000000, 0x00000000},
+    {0x0c000000, 0x00000100, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00008000, 0x070ffe00},
+    {0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000004, 0x00000000},
+    {0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00400c00, 0x00000001, 0x78000000},
+    {0x2132401f, 0x0700c44d, 0x800fff05, 0xc8000169, 0x1afc0000, 0x60030c83, 0x001ac130, 0x27bf0600},
+    {0x2054bf24, 0x00180102, 0x00b85090, 0x00000018, 0x00e00000, 0x80010002, 0x00000000, 0x00000000},
+    {0x00000000, 0x00300000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000},
+    {0x180000e0, 0x00000000, 0x00210000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000},
+    {0x00000000, 0x20010000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000},
+    {0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x02800000, 0x00000000, 0x00000000, 0x00000000},
+    {0x00000010, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00008000, 0x00000000},
+    {0x00000000, 0x00000000, 0x00000000, 0xc0030000, 0x07fe4000, 0x00000000, 0x00000000, 0xffffffc0},
+    {0x04000006, 0x07fc8000, 0x00030000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000},
+    {0xffffffff, 0xfffffff3, 0xffffffff, 0xffffffff, 0xcecfffff, 0xffffffff, 0xffffffff, 0x07b9ffff},
+    {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xbfffffff},
+    {0xffffffff, 0x3fffffff, 0xffff7e00, 0x07f980ff, 0x00613c80, 0x10060130, 0x700e001c, 0xfc08810a},
+    {0xffffffff, 0xffffffff, 0x0000ffff, 0x00000000, 0xffffffff, 0xffffffff, 0x00e7f83f, 0x1ff91a3f},
+    {0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000fff},
+    {0xfffff000, 0xf7ffffff, 0xffffffbf, 0xfdffffff, 0xffffffff, 0xfff0ffff, 0xffffefff, 0xffffffff},
+    {0x00000000, 0x00000000, 0x00000000, 0x071f0000, 0xffff007f, 0x007f01ff, 0x007f0007, 0x00000000}
 };
 
 // clang-format on
@@ -20,6 +20,15 @@
 #include "emojiregistry.h"
 #include "emojidb.cpp"
 
+bool EmojiRegistry::canStartEmoji(std::uint32_t ucs)
+{
+    std::uint32_t block = ucs >> 8;
+    if (block >= sizeof(emojiStartBlocks))
+        return false;
+    quint8 n = emojiStartBlocks[block];
+    return n && (emojiStartBits[n - 1][(ucs & 0xff) >> 5] & (1u << (ucs & 0x1f)));
+}
+
 const EmojiRegistry &EmojiRegistry::instance()
 {
     static EmojiRegistry i;
@@ -57,18 +66,11 @@ EmojiRegistry::Category EmojiRegistry::startCategory(QStringRef in) const
         // number, * or #. excludes 10 keycap
         return Category::SimpleKeycap;
 
-    bool found = false;
-    auto lb    = ranges_.lower_bound(ucs);
-    if (lb == ranges_.end() || lb->first != ucs) {
-        --lb;
-        found = (ucs > lb->first && ucs <= lb->second); // if this is a final range
-    } else
-        found = lb->first == ucs;
-    if (found) {
-        if (ucs >= 0x1f3fb && ucs <= 0x1f3ff)
-            return Category::SkinTone;
+    // skin tone modifiers aren't in the registry on their own
+    if (ucs >= 0x1f3fb && ucs <= 0x1f3ff)
+        return Category::SkinTone;
+    if (canStartEmoji(ucs))
         return Category::Emoji; // there more cases to review. like emoji tags/flags etc
-    }
     return Category::None;
 }
 
@@ -118,7 +120,7 @@ QStringRef EmojiRegistry::findEmoji(const QString &in, int idx) const
             else {
                 gotEmoji = true;
                 if (category == Category::SkinTone) { // if we start from skin modifier then just draw colored rect
-                    idx++;
+                    idx += 2;                         // skin modifiers are surrogate pairs
                     break;
                 }
             }
@@ -131,7 +133,7 @@ QStringRef EmojiRegistry::findEmoji(const QString &in, int idx) const
     return emojiStart == -1 ? QStringRef() : QStringRef(&in, emojiStart, idx - emojiStart);
 }
 
-EmojiRegistry::EmojiRegistry() : groups(std::move(db)), ranges_(std::move(ranges)) { }
+EmojiRegistry::EmojiRegistry() : groups(std::move(db)) { }
 
 EmojiRegistry::iterator &EmojiRegistry::iterator::operator++()
 {
@@ -22,7 +22,7 @@
 
 #include <QString>
 
-#include <map>
+#include <cstdint>
 #include <vector>
 
 class EmojiRegistry {
@@ -62,6 +62,9 @@ public:
     Category startCategory(QStringRef in) const;
     int      count() const;
 
+    /// Returns true if some emoji of the registry starts with the code point
+    static bool canStartEmoji(std::uint32_t ucs);
+
     struct iterator {
         int group_idx    = 0;
         int subgroup_idx = 0;
@@ -86,8 +89,6 @@ private:
     EmojiRegistry();
     EmojiRegistry(const EmojiRegistry &) = delete;
     EmojiRegistry &operator=(const EmojiRegistry &) = delete;
-
-    const std::map<quint32, quint32> ranges_; // start to end range mapping
 };
 
 #endif // EMOJIREGISTRY_H
@@ -0,0 +1,15 @@
+# unittest helpers
+TARGET = emojiregistry
+CONFIG += unittest
+TESTBASEDIR = ../../../../unittest
+include($$TESTBASEDIR/unittest.pri)
+
+INCLUDEPATH += ../..
+DEPENDPATH  += ../..
+
+SOURCES += \
+    testemojiregistry.cpp \
+    ../../emojiregistry.cpp
+
+HEADERS += \
+    ../../emojiregistry.h
@@ -0,0 +1,75 @@
+#include "emojiregistry.h"
+
+#include <QSet>
+#include <QtTest/QtTest>
+
+class TestEmojiRegistry : public QObject {
+    Q_OBJECT
+
+private:
+    QString find(const QString &text) const { return EmojiRegistry::instance().findEmoji(text).toString(); }
+
+private slots:
+    void testStartBitmap()
+    {
+        // the generated bitmap must match the first code points of the registry's emojis
+        QSet<uint> starts;
+        for (const auto &emoji : EmojiRegistry::instance()) {
+            starts.insert(emoji.code.toUcs4().first());
+        }
+        QVERIFY(!starts.isEmpty());
+
+        for (uint ucs = 0; ucs < 0x110000; ucs++) {
+            if (EmojiRegistry::canStartEmoji(ucs) != starts.contains(ucs))
+                QFAIL(qPrintable(QString("mismatch at U+%1").arg(ucs, 4, 16, QChar('0'))));
+        }
+    }
+
+    void testPlainText()
+    {
+        QVERIFY(EmojiRegistry::instance().findEmoji("no emoji here").isNull());
+        QVERIFY(EmojiRegistry::instance().findEmoji("1 # *").isNull());
+    }
+
+    void testSingle()
+    {
+        QCOMPARE(find(QString::fromUtf8("hi \xf0\x9f\x98\x80 there")), QString::fromUtf8("\xf0\x9f\x98\x80"));
+    }
+
+    void testZwj()
+    {
+        // family: man, woman, girl
+        const QString family = QString::fromUtf8("\xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9\xe2\x80\x8d"
+                                                 "\xf0\x9f\x91\xa7");
+        QCOMPARE(find("a " + family + " b"), family);
+
+        // rainbow flag: white flag, FE0F, ZWJ, rainbow
+        const QString flag = QString::fromUtf8("\xf0\x9f\x8f\xb3\xef\xb8\x8f\xe2\x80\x8d\xf0\x9f\x8c\x88");
+        QCOMPARE(find(flag + "!"), flag);
+    }
+
+    void testSkinTone()
+    {
+        // thumbs up, medium skin tone
+        const QString thumbs = QString::fromUtf8("\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd");
+        QCOMPARE(find("ok " + thumbs), thumbs);
+
+        // a lone modifier is shown as is
+        const QString tone = QString::fromUtf8("\xf0\x9f\x8f\xbd");
+        QCOMPARE(find("x" + tone + "x"), tone);
+
+        // two modifiers in a row don't make one emoji
+        QCOMPARE(find(thumbs + tone), thumbs);
+    }
+
+    void testKeycap()
+    {
+        const QString one  = QString::fromUtf8("1\xef\xb8\x8f\xe2\x83\xa3");
+        const QString hash = QString::fromUtf8("#\xef\xb8\x8f\xe2\x83\xa3");
+        QCOMPARE(find("press " + one + " now"), one);
+        QCOMPARE(find(hash + " "), hash);
+    }
+};
+
+QTEST_MAIN(TestEmojiRegistry)
+#include "testemojiregistry.moc"
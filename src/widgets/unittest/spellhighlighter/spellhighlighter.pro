@@ -0,0 +1,17 @@
+# unittest helpers
+TARGET = spellhighlighter
+CONFIG += unittest
+TESTBASEDIR = ../../../../unittest
+include($$TESTBASEDIR/unittest.pri)
+
+QT += gui
+
+INCLUDEPATH += ../../../libpsi/tools ../../../libpsi/tools/spellchecker
+DEPENDPATH  += ../../../libpsi/tools/spellchecker
+
+SOURCES += \
+    testspellhighlighter.cpp \
+    ../../../libpsi/tools/spellchecker/spellhighlighter.cpp
+
+HEADERS += \
+    ../../../libpsi/tools/spellchecker/spellhighlighter.h
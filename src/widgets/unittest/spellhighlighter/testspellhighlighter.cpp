@@ -0,0 +1,144 @@
+#include "spellchecker.h"
+#include "spellhighlighter.h"
+
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTextLayout>
+#include <QtTest/QtTest>
+
+// stands in for the platform checker, which spellchecker.cpp would pick
+class StubChecker : public SpellChecker {
+public:
+    QSet<QString> wrong;
+    QStringList   checked;
+
+    bool isCorrect(const QString &word) override
+    {
+        checked << word;
+        return !wrong.contains(word);
+    }
+    void reload() { invalidate(); }
+};
+
+SpellChecker *SpellChecker::instance()
+{
+    if (!instance_)
+        instance_ = new StubChecker;
+    return instance_;
+}
+
+SpellChecker::SpellChecker() { }
+SpellChecker::~SpellChecker() { }
+bool           SpellChecker::available() const { return true; }
+bool           SpellChecker::writable() const { return false; }
+bool           SpellChecker::isCorrect(const QString &) { return true; }
+QList<QString> SpellChecker::suggestions(const QString &) { return QList<QString>(); }
+bool           SpellChecker::add(const QString &) { return false; }
+void           SpellChecker::requestSuggestions(const QString &word, QObject *,
+                                                std::function<void(const QList<QString> &)> callback)
+{
+    callback(suggestions(word));
+}
+
+SpellChecker *SpellChecker::instance_ = nullptr;
+
+class TestSpellHighlighter : public QObject {
+    Q_OBJECT
+
+private:
+    StubChecker *     checker = nullptr;
+    QTextDocument *   doc     = nullptr;
+    SpellHighlighter *hl      = nullptr;
+
+    // start positions of the underlined ranges in the first block
+    QList<int> underlined() const
+    {
+        QList<int> ret;
+        for (const auto &range : doc->firstBlock().layout()->formats()) {
+            if (range.format.underlineStyle() == QTextCharFormat::SpellCheckUnderline)
+                ret << range.start;
+        }
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+
+    void insert(int pos, const QString &text)
+    {
+        QTextCursor c(doc);
+        c.setPosition(pos);
+        c.insertText(text);
+    }
+
+private slots:
+    void init()
+    {
+        checker = static_cast<StubChecker *>(SpellChecker::instance());
+        checker->wrong = { "helo", "wrld" };
+        checker->checked.clear();
+
+        doc = new QTextDocument(this);
+        doc->setPlainText("helo world foo wrld");
+        hl = new SpellHighlighter(doc);
+        hl->rehighlight();
+    }
+
+    void cleanup()
+    {
+        delete hl;
+        delete doc;
+    }
+
+    void testFirstPass()
+    {
+        QCOMPARE(checker->checked, QStringList({ "helo", "world", "foo", "wrld" }));
+        QCOMPARE(underlined(), QList<int>({ 0, 15 }));
+    }
+
+    void testAppendReusesHead()
+    {
+        checker->checked.clear();
+        insert(19, " bar");
+        // the last word touches the edit, everything before it is taken from the previous pass
+        QCOMPARE(checker->checked, QStringList({ "wrld", "bar" }));
+        QCOMPARE(underlined(), QList<int>({ 0, 15 }));
+    }
+
+    void testPrependReusesTail()
+    {
+        checker->checked.clear();
+        insert(0, "a ");
+        QCOMPARE(checker->checked, QStringList({ "a", "helo" }));
+        // misspellings in the tail move along with the text
+        QCOMPARE(underlined(), QList<int>({ 2, 17 }));
+    }
+
+    void testEditInTheMiddle()
+    {
+        checker->checked.clear();
+        insert(13, "o"); // foo -> fooo
+        QCOMPARE(checker->checked, QStringList({ "fooo" }));
+        QCOMPARE(underlined(), QList<int>({ 0, 16 }));
+    }
+
+    void testSplitWord()
+    {
+        checker->checked.clear();
+        insert(8, " "); // world -> wor ld
+        QCOMPARE(checker->checked, QStringList({ "wor", "ld" }));
+        QCOMPARE(underlined(), QList<int>({ 0, 16 }));
+    }
+
+    void testRevisionChecksEverything()
+    {
+        checker->checked.clear();
+        checker->wrong = { "foo" };
+        checker->reload();
+        hl->rehighlight();
+        QCOMPARE(checker->checked, QStringList({ "helo", "world", "foo", "wrld" }));
+        QCOMPARE(underlined(), QList<int>({ 11 }));
+    }
+};
+
+QTEST_MAIN(TestSpellHighlighter)
+#include "testspellhighlighter.moc"
@@ -35,6 +35,7 @@
 #include <QTextEdit>
 #include <QTextFrame>
 #include <QVBoxLayout>
+#include <QXmlStreamReader>
 
 //----------------------------------------------------------------------------
 // XmlConsole
@@ -46,8 +47,6 @@ XmlConsole::XmlConsole(PsiAccount *_pa) : QWidget()
     pa = _pa;
     pa->dialogRegister(this);
     connect(pa, SIGNAL(updatedAccount()), SLOT(updateCaption()));
-    connect(pa->client(), SIGNAL(xmlIncoming(const QString &)), SLOT(client_xmlIncoming(const QString &)));
-    connect(pa->client(), SIGNAL(xmlOutgoing(const QString &)), SLOT(client_xmlOutgoing(const QString &)));
     connect(pa->psi(), SIGNAL(accountCountChanged()), this, SLOT(updateCaption()));
     updateCaption();
 
@@ -65,6 +64,8 @@ XmlConsole::XmlConsole(PsiAccount *_pa) : QWidget()
     connect(ui_.pb_input, SIGNAL(clicked()), SLOT(insertXml()));
     connect(ui_.pb_close, SIGNAL(clicked()), SLOT(close()));
     connect(ui_.pb_dumpRingbuf, SIGNAL(clicked()), SLOT(dumpRingbuf()));
+    // the client only serializes the traffic while somebody listens
+    connect(ui_.ck_enable, &QCheckBox::toggled, this, &XmlConsole::setTracing);
 
     resize(560, 400);
 }
@@ -89,27 +90,43 @@ void XmlConsole::updateCaption()
 
 void XmlConsole::enable() { ui_.ck_enable->setChecked(true); }
 
+void XmlConsole::setTracing(bool enabled)
+{
+    if (enabled) {
+        connect(pa->client(), &XMPP::Client::xmlIncoming, this, &XmlConsole::client_xmlIncoming, Qt::UniqueConnection);
+        connect(pa->client(), &XMPP::Client::xmlOutgoing, this, &XmlConsole::client_xmlOutgoing, Qt::UniqueConnection);
+    } else {
+        disconnect(pa->client(), &XMPP::Client::xmlIncoming, this, &XmlConsole::client_xmlIncoming);
+        disconnect(pa->client(), &XMPP::Client::xmlOutgoing, this, &XmlConsole::client_xmlOutgoing);
+    }
+}
+
 bool XmlConsole::filtered(const QString &str) const
 {
     if (ui_.ck_enable->isChecked()) {
         // Only do parsing if needed
         if (!ui_.le_jid->text().isEmpty() || !ui_.ck_iq->isChecked() || !ui_.ck_message->isChecked()
             || !ui_.ck_presence->isChecked() || !ui_.ck_sm->isChecked()) {
-            QDomDocument doc;
-            if (!doc.setContent(str))
+            // the first start tag is all we look at, so don't build a document
+            QXmlStreamReader reader(str);
+            reader.setNamespaceProcessing(false);
+            while (!reader.atEnd() && reader.readNext() != QXmlStreamReader::StartElement) { }
+            if (!reader.isStartElement())
                 return true;
 
-            QDomElement e  = doc.documentElement();
-            QString     tn = e.tagName();
-            if ((tn == "iq" && !ui_.ck_iq->isChecked()) || (tn == "message" && !ui_.ck_message->isChecked())
-                || (tn == "presence" && !ui_.ck_presence->isChecked())
-                || ((tn == "a" || tn == "r") && !ui_.ck_sm->isChecked()))
+            QStringRef tn = reader.qualifiedName();
+            if ((tn == QLatin1String("iq") && !ui_.ck_iq->isChecked())
+                || (tn == QLatin1String("message") && !ui_.ck_message->isChecked())
+                || (tn == QLatin1String("presence") && !ui_.ck_presence->isChecked())
+                || ((tn == QLatin1String("a") || tn == QLatin1String("r")) && !ui_.ck_sm->isChecked()))
                 return true;
 
             if (!ui_.le_jid->text().isEmpty()) {
-                Jid  jid(ui_.le_jid->text());
-                bool hasResource = !jid.resource().isEmpty();
-                if (!jid.compare(e.attribute("to"), hasResource) && !jid.compare(e.attribute("from"), hasResource))
+                const QXmlStreamAttributes atts = reader.attributes();
+                Jid                        jid(ui_.le_jid->text());
+                bool                       hasResource = !jid.resource().isEmpty();
+                if (!jid.compare(atts.value("to").toString(), hasResource)
+                    && !jid.compare(atts.value("from").toString(), hasResource))
                     return true;
             }
         }
@@ -43,6 +43,7 @@ private slots:
     void updateCaption();
     void insertXml();
     void dumpRingbuf();
+    void setTracing(bool enabled);
     void client_xmlIncoming(const QString &);
     void client_xmlOutgoing(const QString &);
     void xml_textReady(const QString &);